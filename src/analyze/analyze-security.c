@@ -2283,7 +2283,12 @@ static int property_read_device_allow(
         return sd_bus_message_exit_container(m);
 }
 
-static int acquire_security_info(sd_bus *bus, const char *name, SecurityInfo *info, AnalyzeSecurityFlags flags) {
+static int acquire_security_info(
+                sd_bus *bus,
+                const char *name,
+                sd_bus_message *reply,
+                SecurityInfo *info,
+                AnalyzeSecurityFlags flags) {
 
         static const struct bus_properties_map security_map[] = {
                 { "AmbientCapabilities",     "t",       NULL,                                    offsetof(SecurityInfo, ambient_capabilities)      },
@@ -2337,28 +2342,47 @@ static int acquire_security_info(sd_bus *bus, const char *name, SecurityInfo *in
         };
 
         _cleanup_(sd_bus_error_free) sd_bus_error error = SD_BUS_ERROR_NULL;
-        _cleanup_free_ char *path = NULL;
         int r;
 
-        /* Note: this mangles *info on failure! */
+        /* Note: this mangles *info on failure! If reply is specified, it shall be the reply to an earlier
+         * GetAll() call for the unit, otherwise the properties are requested here. */
 
         assert(bus);
         assert(name);
         assert(info);
 
-        path = unit_dbus_path_from_name(name);
-        if (!path)
-                return log_oom();
+        if (reply) {
+                const sd_bus_error *e;
 
-        r = bus_map_all_properties(
-                        bus,
-                        "org.freedesktop.systemd1",
-                        path,
-                        security_map,
-                        BUS_MAP_STRDUP | BUS_MAP_BOOLEAN_AS_BOOL,
-                        &error,
-                        NULL,
-                        info);
+                e = sd_bus_message_get_error(reply);
+                if (e) {
+                        r = sd_bus_error_get_errno(e);
+                        return log_error_errno(r, "Failed to get unit properties: %s", bus_error_message(e, r));
+                }
+
+                r = bus_message_map_all_properties(
+                                reply,
+                                security_map,
+                                BUS_MAP_STRDUP | BUS_MAP_BOOLEAN_AS_BOOL,
+                                &error,
+                                info);
+        } else {
+                _cleanup_free_ char *path = NULL;
+
+                path = unit_dbus_path_from_name(name);
+                if (!path)
+                        return log_oom();
+
+                r = bus_map_all_properties(
+                                bus,
+                                "org.freedesktop.systemd1",
+                                path,
+                                security_map,
+                                BUS_MAP_STRDUP | BUS_MAP_BOOLEAN_AS_BOOL,
+                                &error,
+                                NULL,
+                                info);
+        }
         if (r < 0)
                 return log_error_errno(r, "Failed to get unit properties: %s", bus_error_message(&error, r));
 
@@ -2409,6 +2433,7 @@ static int acquire_security_info(sd_bus *bus, const char *name, SecurityInfo *in
 
 static int analyze_security_one(sd_bus *bus,
                                 const char *name,
+                                sd_bus_message *reply,
                                 Table *overview_table,
                                 AnalyzeSecurityFlags flags,
                                 unsigned threshold,
@@ -2425,7 +2450,7 @@ static int analyze_security_one(sd_bus *bus,
         assert(bus);
         assert(name);
 
-        r = acquire_security_info(bus, name, info, flags);
+        r = acquire_security_info(bus, name, reply, info, flags);
         if (r == -EMEDIUMTYPE) /* Ignore this one because not loaded or Type is oneshot */
                 return 0;
         if (r < 0)
@@ -2438,6 +2463,110 @@ static int analyze_security_one(sd_bus *bus,
         return 0;
 }
 
+/* How many GetAll() calls to have in flight at the same time when analyzing all units */
+#define PROPERTIES_CALLS_MAX 64U
+
+typedef struct PropertiesCall {
+        sd_bus_slot *slot;
+        sd_bus_message *reply;
+} PropertiesCall;
+
+static void properties_call_array_free(PropertiesCall *calls, size_t n) {
+        FOREACH_ARRAY(c, calls, n) {
+                sd_bus_slot_unref(c->slot);
+                sd_bus_message_unref(c->reply);
+        }
+
+        free(calls);
+}
+
+static int on_properties_reply(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        PropertiesCall *c = ASSERT_PTR(userdata);
+
+        /* Errors are handled by acquire_security_info() */
+        c->reply = sd_bus_message_ref(m);
+        return 0;
+}
+
+static int analyze_security_many(sd_bus *bus,
+                                 char **names,
+                                 Table *overview_table,
+                                 AnalyzeSecurityFlags flags,
+                                 unsigned threshold,
+                                 sd_json_variant *policy,
+                                 PagerFlags pager_flags,
+                                 sd_json_format_flags_t json_format_flags) {
+
+        PropertiesCall *calls = NULL;
+        size_t n_calls = 0, n;
+        int ret = 0, r;
+
+        CLEANUP_ARRAY(calls, n_calls, properties_call_array_free);
+
+        assert(bus);
+
+        /* Like analyze_security_one(), but for many units: the properties of a batch of units are requested
+         * at once, so that we don't have to wait for a round trip to the manager for each unit. The units
+         * are still analyzed in order. */
+
+        n = strv_length(names);
+        if (n == 0)
+                return 0;
+
+        calls = new0(PropertiesCall, MIN(n, PROPERTIES_CALLS_MAX));
+        if (!calls)
+                return log_oom();
+        n_calls = MIN(n, PROPERTIES_CALLS_MAX);
+
+        for (size_t base = 0; base < n; base += n_calls) {
+                size_t k = MIN(n - base, n_calls);
+
+                for (size_t i = 0; i < k; i++) {
+                        _cleanup_free_ char *path = NULL;
+
+                        path = unit_dbus_path_from_name(names[base + i]);
+                        if (!path)
+                                return log_oom();
+
+                        r = sd_bus_call_method_async(
+                                        bus,
+                                        &calls[i].slot,
+                                        "org.freedesktop.systemd1",
+                                        path,
+                                        "org.freedesktop.DBus.Properties",
+                                        "GetAll",
+                                        on_properties_reply,
+                                        calls + i,
+                                        "s", "");
+                        if (r < 0)
+                                return log_error_errno(r, "Failed to request properties of %s: %m", names[base + i]);
+                }
+
+                for (size_t i = 0; i < k; i++) {
+                        while (!calls[i].reply) {
+                                r = sd_bus_process(bus, NULL);
+                                if (r < 0)
+                                        return log_error_errno(r, "Failed to process bus: %m");
+                                if (r > 0)
+                                        continue;
+
+                                r = sd_bus_wait(bus, UINT64_MAX);
+                                if (r < 0)
+                                        return log_error_errno(r, "Failed to wait for bus: %m");
+                        }
+
+                        r = analyze_security_one(bus, names[base + i], calls[i].reply, overview_table, flags, threshold, policy, pager_flags, json_format_flags);
+                        if (r < 0 && ret >= 0)
+                                ret = r;
+
+                        calls[i].slot = sd_bus_slot_unref(calls[i].slot);
+                        calls[i].reply = sd_bus_message_unref(calls[i].reply);
+                }
+        }
+
+        return ret;
+}
+
 /* Refactoring SecurityInfo so that it can make use of existing struct variables instead of reading from dbus */
 static int get_security_info(Unit *u, ExecContext *c, CGroupContext *g, SecurityInfo **ret_info) {
         assert(ret_info);
@@ -2829,6 +2958,10 @@ static int analyze_security(sd_bus *bus,
                         if (!endswith(info.id, ".service"))
                                 continue;
 
+                        /* Units that aren't loaded are skipped anyway, hence don't bother */
+                        if (!streq(info.load_state, "loaded"))
+                                continue;
+
                         if (!GREEDY_REALLOC(list, n + 2))
                                 return log_oom();
 
@@ -2843,11 +2976,9 @@ static int analyze_security(sd_bus *bus,
 
                 flags |= ANALYZE_SECURITY_SHORT|ANALYZE_SECURITY_ONLY_LOADED|ANALYZE_SECURITY_ONLY_LONG_RUNNING;
 
-                STRV_FOREACH(i, list) {
-                        r = analyze_security_one(bus, *i, overview_table, flags, threshold, policy, pager_flags, json_format_flags);
-                        if (r < 0 && ret >= 0)
-                                ret = r;
-                }
+                r = analyze_security_many(bus, list, overview_table, flags, threshold, policy, pager_flags, json_format_flags);
+                if (r < 0 && ret >= 0)
+                        ret = r;
 
         } else
                 STRV_FOREACH(i, units) {
@@ -2877,7 +3008,7 @@ static int analyze_security(sd_bus *bus,
                         } else
                                 name = mangled;
 
-                        r = analyze_security_one(bus, name, overview_table, flags, threshold, policy, pager_flags, json_format_flags);
+                        r = analyze_security_one(bus, name, /* reply = */ NULL, overview_table, flags, threshold, policy, pager_flags, json_format_flags);
                         if (r < 0 && ret >= 0)
                                 ret = r;
                 }
@@ -2,6 +2,7 @@
 
 #include <inttypes.h>
 #include <malloc.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -60,12 +61,13 @@ DEFINE_TRIVIAL_CLEANUP_FUNC_FULL(LZ4F_decompressionContext_t, sym_LZ4F_freeDecom
 static void *zstd_dl = NULL;
 
 static DLSYM_PROTOTYPE(ZSTD_CCtx_setParameter) = NULL;
-static DLSYM_PROTOTYPE(ZSTD_compress) = NULL;
+static DLSYM_PROTOTYPE(ZSTD_compressCCtx) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_compressStream2) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_createCCtx) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_createDCtx) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_CStreamInSize) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_CStreamOutSize) = NULL;
+static DLSYM_PROTOTYPE(ZSTD_DCtx_reset) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_decompressStream) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_DStreamInSize) = NULL;
 static DLSYM_PROTOTYPE(ZSTD_DStreamOutSize) = NULL;
@@ -79,6 +81,95 @@ static DLSYM_PROTOTYPE(ZSTD_isError) = NULL;
 DEFINE_TRIVIAL_CLEANUP_FUNC_FULL(ZSTD_CCtx*, sym_ZSTD_freeCCtx, NULL);
 DEFINE_TRIVIAL_CLEANUP_FUNC_FULL(ZSTD_DCtx*, sym_ZSTD_freeDCtx, NULL);
 
+/* Setting up a zstd context is expensive compared to compressing or decompressing a short blob, which is
+ * what the journal does for every data object. Hence keep one context of each kind around per thread and
+ * reuse it for the one-shot blob operations below. They are stored as thread-specific data rather than in
+ * thread_local variables, so that they are freed again when the thread exits. */
+typedef struct ZstdContexts {
+        ZSTD_CCtx *cctx;
+        ZSTD_DCtx *dctx;
+} ZstdContexts;
+
+static pthread_key_t zstd_contexts_key;
+static bool zstd_contexts_key_valid = false;
+
+static void zstd_contexts_free(void *p) {
+        ZstdContexts *c = p;
+
+        if (!c)
+                return;
+
+        sym_ZSTD_freeCCtx(c->cctx);
+        sym_ZSTD_freeDCtx(c->dctx);
+        free(c);
+}
+
+static void zstd_contexts_key_initialize(void) {
+        zstd_contexts_key_valid = pthread_key_create(&zstd_contexts_key, zstd_contexts_free) == 0;
+}
+
+_destructor_ static void zstd_contexts_key_delete(void) {
+        if (!zstd_contexts_key_valid)
+                return;
+
+        /* We might be part of a shared library that is unloaded. Make sure no thread exiting later on calls
+         * into our destructor anymore. */
+        zstd_contexts_free(pthread_getspecific(zstd_contexts_key));
+        (void) pthread_key_delete(zstd_contexts_key);
+        zstd_contexts_key_valid = false;
+}
+
+static ZstdContexts* zstd_get_contexts(void) {
+        static pthread_once_t once = PTHREAD_ONCE_INIT;
+        ZstdContexts *c;
+
+        assert_se(pthread_once(&once, zstd_contexts_key_initialize) == 0);
+        if (!zstd_contexts_key_valid)
+                return NULL;
+
+        c = pthread_getspecific(zstd_contexts_key);
+        if (c)
+                return c;
+
+        c = new0(ZstdContexts, 1);
+        if (!c)
+                return NULL;
+
+        if (pthread_setspecific(zstd_contexts_key, c) != 0)
+                return mfree(c);
+
+        return c;
+}
+
+static ZSTD_CCtx* zstd_get_cctx(void) {
+        ZstdContexts *c;
+
+        c = zstd_get_contexts();
+        if (!c)
+                return NULL;
+
+        if (!c->cctx)
+                c->cctx = sym_ZSTD_createCCtx();
+
+        return c->cctx;
+}
+
+static ZSTD_DCtx* zstd_get_dctx(void) {
+        ZstdContexts *c;
+
+        c = zstd_get_contexts();
+        if (!c)
+                return NULL;
+
+        if (!c->dctx)
+                c->dctx = sym_ZSTD_createDCtx();
+        else
+                /* The previous operation might have stopped in the middle of a frame, start afresh. */
+                (void) sym_ZSTD_DCtx_reset(c->dctx, ZSTD_reset_session_only);
+
+        return c->dctx;
+}
+
 static int zstd_ret_to_errno(size_t ret) {
         switch (sym_ZSTD_getErrorCode(ret)) {
         case ZSTD_error_dstSize_tooSmall:
@@ -290,13 +381,14 @@ int dlopen_zstd(void) {
                         &zstd_dl,
                         "libzstd.so.1", LOG_DEBUG,
                         DLSYM_ARG(ZSTD_getErrorCode),
-                        DLSYM_ARG(ZSTD_compress),
+                        DLSYM_ARG(ZSTD_compressCCtx),
                         DLSYM_ARG(ZSTD_getFrameContentSize),
                         DLSYM_ARG(ZSTD_decompressStream),
                         DLSYM_ARG(ZSTD_getErrorName),
                         DLSYM_ARG(ZSTD_DStreamOutSize),
                         DLSYM_ARG(ZSTD_CStreamInSize),
                         DLSYM_ARG(ZSTD_CStreamOutSize),
+                        DLSYM_ARG(ZSTD_DCtx_reset),
                         DLSYM_ARG(ZSTD_CCtx_setParameter),
                         DLSYM_ARG(ZSTD_compressStream2),
                         DLSYM_ARG(ZSTD_DStreamInSize),
@@ -319,6 +411,7 @@ int compress_blob_zstd(
         assert(dst_size);
 
 #if HAVE_ZSTD
+        ZSTD_CCtx *cctx;
         size_t k;
         int r;
 
@@ -326,7 +419,11 @@ int compress_blob_zstd(
         if (r < 0)
                 return r;
 
-        k = sym_ZSTD_compress(dst, dst_alloc_size, src, src_size, level < 0 ? 0 : level);
+        cctx = zstd_get_cctx();
+        if (!cctx)
+                return -ENOMEM;
+
+        k = sym_ZSTD_compressCCtx(cctx, dst, dst_alloc_size, src, src_size, level < 0 ? 0 : level);
         if (sym_ZSTD_isError(k))
                 return zstd_ret_to_errno(k);
 
@@ -477,7 +574,7 @@ int decompress_blob_zstd(
         if (!(greedy_realloc(dst, MAX(sym_ZSTD_DStreamOutSize(), size), 1)))
                 return -ENOMEM;
 
-        _cleanup_(sym_ZSTD_freeDCtxp) ZSTD_DCtx *dctx = sym_ZSTD_createDCtx();
+        ZSTD_DCtx *dctx = zstd_get_dctx();
         if (!dctx)
                 return -ENOMEM;
 
@@ -696,7 +793,7 @@ int decompress_startswith_zstd(
         if (size < prefix_len + 1)
                 return 0; /* Decompressed text too short to match the prefix and extra */
 
-        _cleanup_(sym_ZSTD_freeDCtxp) ZSTD_DCtx *dctx = sym_ZSTD_createDCtx();
+        ZSTD_DCtx *dctx = zstd_get_dctx();
         if (!dctx)
                 return -ENOMEM;
 
@@ -1081,6 +1178,9 @@ int decompress_stream_lz4(int in, int out, uint64_t max_bytes) {
 #endif
 }
 
+#define ZSTD_WORKERS_MIN_SIZE (64U * U64_MB)
+#define ZSTD_WORKERS_MAX 4
+
 int compress_stream_zstd(int fdf, int fdt, uint64_t max_bytes, uint64_t *ret_uncompressed_size) {
         assert(fdf >= 0);
         assert(fdt >= 0);
@@ -1091,6 +1191,7 @@ int compress_stream_zstd(int fdf, int fdt, uint64_t max_bytes, uint64_t *ret_unc
         size_t in_allocsize, out_allocsize;
         size_t z;
         uint64_t left = max_bytes, in_bytes = 0;
+        struct stat st;
         int r;
 
         r = dlopen_zstd();
@@ -1110,6 +1211,24 @@ int compress_stream_zstd(int fdf, int fdt, uint64_t max_bytes, uint64_t *ret_unc
         if (sym_ZSTD_isError(z))
                 log_debug("Failed to enable ZSTD checksum, ignoring: %s", sym_ZSTD_getErrorName(z));
 
+        /* Compressing a large file (think core dump of a big process) on a single CPU takes a long time,
+         * hence let zstd spread the work over a few worker threads in that case. The output is a regular
+         * zstd frame either way. If libzstd is built without multi-threading support this fails, and we
+         * simply stay single-threaded.
+         *
+         * Note that we otherwise avoid threads in our code. This is fine here: the workers only exist for
+         * the duration of this call, ZSTD_freeCCtx() on the way out joins them, and the only caller
+         * compressing files this large, systemd-coredump, doesn't fork() or clone() in the meantime. */
+        if (fstat(fdf, &st) >= 0 && S_ISREG(st.st_mode) && (uint64_t) st.st_size >= ZSTD_WORKERS_MIN_SIZE) {
+                long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+                if (n > 1) {
+                        z = sym_ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, (int) MIN(n, ZSTD_WORKERS_MAX));
+                        if (sym_ZSTD_isError(z))
+                                log_debug("Failed to enable ZSTD worker threads, ignoring: %s", sym_ZSTD_getErrorName(z));
+                }
+        }
+
         /* This loop read from the input file, compresses that entire chunk,
          * and writes all output produced to the output file.
          */
@@ -17,6 +17,21 @@
 #include "strv.h"
 #include "utf8.h"
 
+static size_t plain_run_length(const char *p, const char *separators, ExtractFlags flags) {
+        const char *q;
+
+        /* Returns the number of characters at the beginning of p that need no special treatment outside of
+         * quotes, i.e. that are neither separators, nor quotes or backslashes which we shall process. */
+
+        for (q = p; *q; q++)
+                if ((*q == '\\' && !(flags & EXTRACT_RETAIN_ESCAPE)) ||
+                    (IN_SET(*q, '\'', '"') && (flags & (EXTRACT_KEEP_QUOTE | EXTRACT_UNQUOTE))) ||
+                    strchr(separators, *q))
+                        break;
+
+        return q - p;
+}
+
 int extract_first_word(const char **p, char **ret, const char *separators, ExtractFlags flags) {
         _cleanup_free_ char *s = NULL;
         size_t sz = 0;
@@ -142,6 +157,19 @@ int extract_first_word(const char **p, char **ret, const char *separators, Extra
                         }
 
                 } else {
+                        /* Copy a run of ordinary characters in one go, instead of growing the buffer for
+                         * each of them. */
+                        size_t n = plain_run_length(*p, separators, flags);
+                        if (n > 0) {
+                                if (!GREEDY_REALLOC(s, sz+n+1))
+                                        return -ENOMEM;
+
+                                memcpy(s + sz, *p, n);
+                                sz += n;
+                                *p += n;
+                                c = **p;
+                        }
+
                         for (;; (*p)++, c = **p) {
                                 if (c == 0)
                                         goto finish_force_terminate;
@@ -130,6 +130,27 @@ bool utf8_is_printable_newline(const char* str, size_t length, bool allow_newlin
         return true;
 }
 
+static size_t ascii_words_prefix(const char *str, size_t len_bytes) {
+        size_t i = 0;
+
+        /* Returns the length of the run of non-NUL ASCII characters at the beginning of the string, checked
+         * 8 bytes at a time. Stops at the first word containing anything else, hence the caller has to
+         * look at the remaining bytes itself. */
+
+        for (; len_bytes - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+                uint64_t w;
+
+                memcpy(&w, str + i, sizeof(w));
+
+                /* Any byte with the high bit set, or any NUL byte? */
+                if ((w & UINT64_C(0x8080808080808080)) != 0 ||
+                    ((w - UINT64_C(0x0101010101010101)) & ~w & UINT64_C(0x8080808080808080)) != 0)
+                        break;
+        }
+
+        return i;
+}
+
 char* utf8_is_valid_n(const char *str, size_t len_bytes) {
         /* Check if the string is composed of valid utf8 characters. If length len_bytes is given, stop after
          * len_bytes. Otherwise, stop at NUL. */
@@ -139,9 +160,21 @@ char* utf8_is_valid_n(const char *str, size_t len_bytes) {
         for (size_t i = 0; len_bytes != SIZE_MAX ? i < len_bytes : str[i] != '\0'; ) {
                 int len;
 
+                if (len_bytes != SIZE_MAX) {
+                        /* If we know the length, skip over plain ASCII in word sized steps */
+                        i += ascii_words_prefix(str + i, len_bytes - i);
+                        if (i >= len_bytes)
+                                break;
+                }
+
                 if (_unlikely_(str[i] == '\0'))
                         return NULL; /* embedded NUL */
 
+                if ((uint8_t) str[i] < 0x80) {
+                        i++; /* ASCII is always valid, avoid the function call */
+                        continue;
+                }
+
                 len = utf8_encoded_valid_unichar(str + i,
                                                  len_bytes != SIZE_MAX ? len_bytes - i : SIZE_MAX);
                 if (_unlikely_(len < 0))
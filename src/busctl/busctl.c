@@ -1352,7 +1352,6 @@ static int monitor(int argc, char **argv, int (*dump)(sd_bus_message *m, FILE *f
                         }
 
                         dump(m, stdout);
-                        fflush(stdout);
 
                         if (arg_limit_messages != UINT64_MAX) {
                                 arg_limit_messages--;
@@ -1376,6 +1375,10 @@ static int monitor(int argc, char **argv, int (*dump)(sd_bus_message *m, FILE *f
                 if (r > 0)
                         continue;
 
+                /* Only flush once we have processed everything queued, i.e. before going to sleep, so that
+                 * bursts of messages end up in few large writes, instead of one per message. */
+                fflush(stdout);
+
                 r = sd_bus_wait(bus, arg_timeout > 0 ? usec_sub_unsigned(end, now(CLOCK_MONOTONIC)) : UINT64_MAX);
                 if (r == 0 && arg_timeout > 0 && now(CLOCK_MONOTONIC) >= end) {
                         if (!arg_quiet && !sd_json_format_enabled(arg_json_format_flags))
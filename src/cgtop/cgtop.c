@@ -513,10 +513,37 @@ static int refresh_one(
         return 1;
 }
 
+static bool controller_is_useful(const char *controller, bool all_unified) {
+        assert(controller);
+
+        /* Returns false for controllers for which process() wouldn't collect anything. On the unified
+         * hierarchy all controllers share the same tree, hence walking it for these would only mean
+         * enumerating all cgroups once more for nothing. */
+
+        if (!all_unified)
+                return !streq(controller, "io");
+
+        if (STR_IN_SET(controller, "cpuacct", "blkio"))
+                return false;
+        if (streq(controller, "pids"))
+                return arg_count == COUNT_PIDS;
+        if (streq(controller, SYSTEMD_CGROUP_CONTROLLER))
+                return IN_SET(arg_count, COUNT_ALL_PROCESSES, COUNT_USERSPACE_PROCESSES);
+
+        return true;
+}
+
 static int refresh(const char *root, Hashmap *a, Hashmap *b, unsigned iteration) {
-        int r;
+        int r, all_unified;
+
+        all_unified = cg_all_unified();
+        if (all_unified < 0)
+                return all_unified;
 
         FOREACH_STRING(c, SYSTEMD_CGROUP_CONTROLLER, "cpu", "cpuacct", "memory", "io", "blkio", "pids") {
+                if (!controller_is_useful(c, all_unified))
+                        continue;
+
                 r = refresh_one(c, root, a, b, iteration, 0, NULL);
                 if (r < 0)
                         return r;
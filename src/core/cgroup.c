@@ -31,6 +31,7 @@
 #include "parse-util.h"
 #include "path-util.h"
 #include "percent-util.h"
+#include "pidfd-util.h"
 #include "process-util.h"
 #include "procfs-util.h"
 #include "set.h"
@@ -2224,6 +2225,27 @@ int unit_set_cgroup_path(Unit *u, const char *path) {
         return 1;
 }
 
+static void unit_set_cgroup_id(Unit *u, uint64_t cgroup_id) {
+        int r;
+
+        assert(u);
+
+        CGroupRuntime *crt = ASSERT_PTR(unit_get_cgroup_runtime(u));
+
+        if (crt->cgroup_id != 0)
+                (void) hashmap_remove_value(u->manager->cgroup_id_unit, &crt->cgroup_id, u);
+
+        crt->cgroup_id = cgroup_id;
+        if (cgroup_id == 0)
+                return;
+
+        /* cgroup IDs are never reused during runtime, hence this can't ever map a process to the wrong unit,
+         * even if the entry is stale. */
+        r = hashmap_ensure_put(&u->manager->cgroup_id_unit, &uint64_hash_ops, &crt->cgroup_id, u);
+        if (r < 0)
+                log_unit_debug_errno(u, r, "Failed to add cgroup ID %" PRIu64 " to lookup table, ignoring: %m", cgroup_id);
+}
+
 int unit_watch_cgroup(Unit *u) {
         _cleanup_free_ char *events = NULL;
         int r;
@@ -2394,7 +2416,7 @@ static int unit_update_cgroup(
         } else
                 log_unit_warning_errno(u, r, "Failed to get full cgroup path on cgroup %s, ignoring: %m", empty_to_root(crt->cgroup_path));
 
-        crt->cgroup_id = cgroup_id;
+        unit_set_cgroup_id(u, cgroup_id);
 
         /* Start watching it */
         (void) unit_watch_cgroup(u);
@@ -2977,6 +2999,9 @@ void unit_release_cgroup(Unit *u, bool drop_cgroup_runtime) {
                 crt->cgroup_path = mfree(crt->cgroup_path);
         }
 
+        if (crt->cgroup_id != 0)
+                (void) hashmap_remove_value(u->manager->cgroup_id_unit, &crt->cgroup_id, u);
+
         if (crt->cgroup_control_inotify_wd >= 0) {
                 if (inotify_rm_watch(u->manager->cgroup_inotify_fd, crt->cgroup_control_inotify_wd) < 0)
                         log_unit_debug_errno(u, errno, "Failed to remove cgroup control inotify watch %i for %s, ignoring: %m", crt->cgroup_control_inotify_wd, u->id);
@@ -3694,9 +3719,21 @@ Unit* manager_get_unit_by_cgroup(Manager *m, const char *cgroup) {
 
 Unit *manager_get_unit_by_pidref_cgroup(Manager *m, const PidRef *pid) {
         _cleanup_free_ char *cgroup = NULL;
+        uint64_t cgroup_id;
 
         assert(m);
 
+        /* If we have a pidfd, try to find the unit by the cgroup ID the kernel reports for it first. This
+         * avoids reading and parsing /proc/$PID/cgroup. If the process sits in a sub-cgroup of a unit
+         * (e.g. with delegation), this finds nothing, and we fall back to the path lookup below. */
+        if (pid && pid->fd >= 0 && pidfd_get_cgroupid(pid->fd, &cgroup_id) >= 0) {
+                Unit *u;
+
+                u = hashmap_get(m->cgroup_id_unit, &cgroup_id);
+                if (u)
+                        return u;
+        }
+
         if (cg_pidref_get_path(SYSTEMD_CGROUP_CONTROLLER, pid, &cgroup) < 0)
                 return NULL;
 
@@ -4733,8 +4770,19 @@ int cgroup_runtime_deserialize_one(Unit *u, const char *key, const char *value,
                 return 1;
         }
 
-        if (MATCH_DESERIALIZE_IMMEDIATE(u, "cgroup-id", key, value, safe_atou64, cgroup_id))
+        if (streq(key, "cgroup-id")) {
+                uint64_t cgroup_id;
+
+                r = safe_atou64(value, &cgroup_id);
+                if (r < 0)
+                        log_unit_debug_errno(u, r, "Failed to parse \"%s=%s\", ignoring", key, value);
+                else if (!unit_setup_cgroup_runtime(u))
+                        log_oom_debug();
+                else
+                        unit_set_cgroup_id(u, cgroup_id);
+
                 return 1;
+        }
 
         if (MATCH_DESERIALIZE(u, "cgroup-realized", key, value, parse_boolean, cgroup_realized))
                 return 1;
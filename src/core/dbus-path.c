@@ -110,7 +110,6 @@ static int bus_path_set_transient_property(
                                         .unit = u,
                                         .path = TAKE_PTR(k),
                                         .type = t,
-                                        .inotify_fd = -EBADF,
                                 };
 
                                 LIST_PREPEND(spec, p->specs, s);
@@ -2199,7 +2199,6 @@ int config_parse_path_spec(const char *unit,
         s->unit = UNIT(p);
         s->path = TAKE_PTR(k);
         s->type = b;
-        s->inotify_fd = -EBADF;
 
         LIST_PREPEND(spec, p->specs, s);
 
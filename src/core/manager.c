@@ -917,6 +917,7 @@ int manager_new(RuntimeScope runtime_scope, ManagerTestRunFlags test_run_flags,
                 .pidref_transport_fds = EBADF_PAIR,
                 .private_listen_fd = -EBADF,
                 .dev_autofs_fd = -EBADF,
+                .path_inotify_fd = -EBADF,
                 .cgroup_inotify_fd = -EBADF,
                 .pin_cgroupfs_fd = -EBADF,
                 .idle_pipe = { -EBADF, -EBADF, -EBADF, -EBADF},
@@ -1698,6 +1699,8 @@ Manager* manager_free(Manager *m) {
         safe_close_pair(m->handoff_timestamp_fds);
         safe_close_pair(m->pidref_transport_fds);
 
+        path_inotify_done(m);
+
         manager_close_ask_password(m);
 
         manager_close_idle_pipe(m);
@@ -1711,6 +1714,7 @@ Manager* manager_free(Manager *m) {
         strv_free(m->client_environment);
 
         hashmap_free(m->cgroup_unit);
+        hashmap_free(m->cgroup_id_unit);
         manager_free_unit_name_maps(m);
 
         free(m->switch_root);
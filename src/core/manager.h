@@ -19,6 +19,7 @@
 #include "ratelimit.h"
 
 struct libmnt_monitor;
+typedef struct PathSpec PathSpec;
 typedef struct Unit Unit;
 
 /* Enforce upper limit how many names we allow */
@@ -358,8 +359,17 @@ struct Manager {
         /* Data specific to the Automount subsystem */
         int dev_autofs_fd;
 
+        /* Data specific to the path subsystem: a single inotify instance shared by all PathSpec objects,
+         * i.e. by path units and PIDFile= watches. Maps each watch descriptor to the set of PathSpec
+         * objects using it, and queues the PathSpec objects with events read but not dispatched yet. */
+        int path_inotify_fd;
+        sd_event_source *path_inotify_event_source;
+        Hashmap *path_inotify_wd_specs;
+        LIST_HEAD(PathSpec, path_inotify_pending);
+
         /* Data specific to the cgroup subsystem */
         Hashmap *cgroup_unit;
+        Hashmap *cgroup_id_unit; /* cgroup ID → unit, for looking up the unit of a pidfd without procfs */
         CGroupMask cgroup_supported;
         char *cgroup_root;
 
@@ -34,9 +34,113 @@ static const UnitActiveState state_translation_table[_PATH_STATE_MAX] = {
         [PATH_FAILED]  = UNIT_FAILED,
 };
 
-static int path_dispatch_io(sd_event_source *source, int fd, uint32_t revents, void *userdata);
+static int path_dispatch_spec(PathSpec *s, int error, bool changed);
 
-int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler) {
+static int path_inotify_dispatch(sd_event_source *source, int fd, uint32_t revents, void *userdata);
+
+static int path_inotify_setup(Manager *m) {
+        _cleanup_close_ int fd = -EBADF;
+        int r;
+
+        assert(m);
+
+        /* All path specs share a single inotify instance, so that we need neither an fd nor an event
+         * source per watched path. The kernel merges watches on the same inode into one watch descriptor,
+         * hence we keep track of which path specs use which watch descriptor, and which events each of
+         * them is interested in, see path_spec_add_watch() and path_inotify_queue_event(). */
+
+        if (m->path_inotify_fd >= 0)
+                return 0;
+
+        fd = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+        if (fd < 0)
+                return log_error_errno(errno, "Failed to allocate inotify fd: %m");
+
+        r = sd_event_add_io(m->event, &m->path_inotify_event_source, fd, EPOLLIN, path_inotify_dispatch, m);
+        if (r < 0)
+                return log_error_errno(r, "Failed to add inotify fd to event loop: %m");
+
+        (void) sd_event_source_set_description(m->path_inotify_event_source, "path-inotify");
+
+        m->path_inotify_fd = TAKE_FD(fd);
+        return 0;
+}
+
+void path_inotify_done(Manager *m) {
+        assert(m);
+
+        m->path_inotify_wd_specs = hashmap_free_with_destructor(m->path_inotify_wd_specs, set_free);
+        m->path_inotify_event_source = sd_event_source_disable_unref(m->path_inotify_event_source);
+        m->path_inotify_fd = asynchronous_close(m->path_inotify_fd);
+}
+
+static void path_inotify_release_wd(Manager *m, int wd) {
+        assert(m);
+
+        if (!set_isempty(hashmap_get(m->path_inotify_wd_specs, INT_TO_PTR(wd))))
+                return;
+
+        /* Nobody is interested in this watch anymore. It might be gone already, if the inode was removed,
+         * hence ignore any errors. */
+        set_free(hashmap_remove(m->path_inotify_wd_specs, INT_TO_PTR(wd)));
+        (void) inotify_rm_watch(m->path_inotify_fd, wd);
+}
+
+static int path_spec_add_watch(PathSpec *s, int wd, uint32_t mask) {
+        Manager *m = ASSERT_PTR(s->unit->manager);
+        Set *specs;
+        int r;
+
+        assert(wd >= 0);
+
+        mask &= IN_ALL_EVENTS;
+
+        /* If we are already using this watch descriptor, e.g. for the target of a symlink or for a parent
+         * directory, then only update the events we are interested in, like a plain inotify_add_watch()
+         * without IN_MASK_ADD would do on a private inotify instance. */
+        FOREACH_ARRAY(w, s->watches, s->n_watches)
+                if (w->wd == wd) {
+                        w->mask = mask;
+                        return 0;
+                }
+
+        if (!GREEDY_REALLOC(s->watches, s->n_watches + 1)) {
+                r = -ENOMEM;
+                goto fail;
+        }
+
+        specs = hashmap_get(m->path_inotify_wd_specs, INT_TO_PTR(wd));
+        if (specs) {
+                r = set_put(specs, s);
+                if (r < 0)
+                        goto fail;
+        } else {
+                _cleanup_set_free_ Set *new_specs = NULL;
+
+                r = set_ensure_put(&new_specs, NULL, s);
+                if (r < 0)
+                        goto fail;
+
+                r = hashmap_ensure_put(&m->path_inotify_wd_specs, NULL, INT_TO_PTR(wd), new_specs);
+                if (r < 0)
+                        goto fail;
+
+                TAKE_PTR(new_specs);
+        }
+
+        s->watches[s->n_watches++] = (PathSpecWatch) {
+                .wd = wd,
+                .mask = mask,
+        };
+
+        return 0;
+
+fail:
+        path_inotify_release_wd(m, wd);
+        return r;
+}
+
+int path_spec_watch(PathSpec *s, path_spec_handler_t handler) {
         static const int flags_table[_PATH_TYPE_MAX] = {
                 [PATH_EXISTS]              = IN_DELETE_SELF|IN_MOVE_SELF|IN_ATTRIB,
                 [PATH_EXISTS_GLOB]         = IN_DELETE_SELF|IN_MOVE_SELF|IN_ATTRIB,
@@ -47,27 +151,22 @@ int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler) {
 
         bool exists = false;
         char *slash, *oldslash = NULL;
+        Manager *m;
         int r;
 
         assert(s);
         assert(s->unit);
         assert(handler);
 
-        path_spec_unwatch(s);
+        m = ASSERT_PTR(s->unit->manager);
 
-        s->inotify_fd = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
-        if (s->inotify_fd < 0) {
-                r = log_error_errno(errno, "Failed to allocate inotify fd: %m");
-                goto fail;
-        }
+        path_spec_unwatch(s);
 
-        r = sd_event_add_io(s->unit->manager->event, &s->event_source, s->inotify_fd, EPOLLIN, handler, s);
-        if (r < 0) {
-                log_error_errno(r, "Failed to add inotify fd to event loop: %m");
-                goto fail;
-        }
+        r = path_inotify_setup(m);
+        if (r < 0)
+                return r;
 
-        (void) sd_event_source_set_description(s->event_source, "path");
+        s->handler = handler;
 
         /* This function assumes the path was passed through path_simplify()! */
         assert(!strstr(s->path, "//"));
@@ -96,7 +195,10 @@ int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler) {
 
                         SET_FLAG(f, IN_DONT_FOLLOW, !follow_symlink);
 
-                        wd = inotify_add_watch(s->inotify_fd, s->path, f);
+                        /* Never drop the events other path specs asked for on the same inode. */
+                        f |= IN_MASK_ADD;
+
+                        wd = inotify_add_watch(m->path_inotify_fd, s->path, f);
                         if (wd < 0) {
                                 if (IN_SET(errno, EACCES, ENOENT)) {
                                         incomplete = true; /* This is an expected error, let's accept this
@@ -107,7 +209,7 @@ int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler) {
 
                                 /* This second call to inotify_add_watch() should fail like the previous one
                                  * and is done for logging the error in a comprehensive way. */
-                                wd = inotify_add_watch_and_warn(s->inotify_fd, s->path, f);
+                                wd = inotify_add_watch_and_warn(m->path_inotify_fd, s->path, f);
                                 if (wd < 0) {
                                         if (cut)
                                                 *cut = tmp;
@@ -118,6 +220,16 @@ int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler) {
 
                                 /* Hmm, we succeeded in adding the watch this time... let's continue. */
                         }
+
+                        r = path_spec_add_watch(s, wd, f);
+                        if (r < 0) {
+                                log_error_errno(r, "Failed to track inotify watch for %s: %m", s->path);
+
+                                if (cut)
+                                        *cut = tmp;
+
+                                goto fail;
+                        }
                 }
 
                 if (incomplete) {
@@ -133,9 +245,12 @@ int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler) {
                 if (oldslash) {
                         char *cut2 = oldslash + (oldslash == s->path);
                         char tmp2 = *cut2;
+                        int parent_wd;
                         *cut2 = '\0';
 
-                        (void) inotify_add_watch(s->inotify_fd, s->path, IN_MOVE_SELF);
+                        parent_wd = inotify_add_watch(m->path_inotify_fd, s->path, IN_MOVE_SELF|IN_MASK_ADD);
+                        if (parent_wd >= 0)
+                                (void) path_spec_add_watch(s, parent_wd, IN_MOVE_SELF);
                         /* Error is ignored, the worst can happen is we get spurious events. */
 
                         *cut2 = tmp2;
@@ -166,35 +281,145 @@ fail:
         return r;
 }
 
+static void path_inotify_queue(Manager *m, PathSpec *s, int error, bool changed) {
+        assert(m);
+        assert(s);
+
+        /* Queueing must not fail, as it happens while reading events from the shared inotify instance, where
+         * we couldn't tell the affected path spec about it otherwise. Hence use a list, not a hashmap. */
+
+        if (!s->in_inotify_pending) {
+                LIST_PREPEND(inotify_pending, m->path_inotify_pending, s);
+                s->in_inotify_pending = true;
+        }
+
+        s->pending_changed = s->pending_changed || changed;
+        if (error < 0)
+                s->pending_error = error;
+}
+
+static void path_inotify_unqueue(Manager *m, PathSpec *s) {
+        assert(m);
+        assert(s);
+
+        if (s->in_inotify_pending) {
+                LIST_REMOVE(inotify_pending, m->path_inotify_pending, s);
+                s->in_inotify_pending = false;
+        }
+
+        s->pending_changed = false;
+        s->pending_error = 0;
+}
+
 void path_spec_unwatch(PathSpec *s) {
+        Manager *m;
+
         assert(s);
+        assert(s->unit);
 
-        s->event_source = sd_event_source_disable_unref(s->event_source);
-        s->inotify_fd = asynchronous_close(s->inotify_fd);
+        m = ASSERT_PTR(s->unit->manager);
+
+        FOREACH_ARRAY(w, s->watches, s->n_watches) {
+                (void) set_remove(hashmap_get(m->path_inotify_wd_specs, INT_TO_PTR(w->wd)), s);
+                path_inotify_release_wd(m, w->wd);
+        }
+
+        s->watches = mfree(s->watches);
+        s->n_watches = 0;
+
+        /* Drop events we read already, but did not dispatch yet */
+        path_inotify_unqueue(m, s);
 }
 
-int path_spec_fd_event(PathSpec *s, uint32_t revents) {
-        union inotify_event_buffer buffer;
-        ssize_t l;
+static void path_inotify_queue_all(Manager *m, int error) {
+        Set *specs;
+        PathSpec *s;
+
+        assert(m);
+
+        HASHMAP_FOREACH(specs, m->path_inotify_wd_specs)
+                SET_FOREACH(s, specs)
+                        path_inotify_queue(m, s, error, /* changed = */ false);
+}
 
+static void path_inotify_queue_event(Manager *m, PathSpec *s, const struct inotify_event *e) {
+        assert(m);
         assert(s);
+        assert(e);
 
-        if (revents != EPOLLIN)
-                return log_error_errno(SYNTHETIC_ERRNO(EINVAL),
-                                       "Got invalid poll event on inotify.");
+        FOREACH_ARRAY(w, s->watches, s->n_watches) {
+                if (w->wd != e->wd)
+                        continue;
 
-        l = read(s->inotify_fd, &buffer, sizeof(buffer));
-        if (l < 0) {
-                if (ERRNO_IS_TRANSIENT(errno))
-                        return 0;
+                /* The watch descriptor might be shared with other path specs, which asked for different
+                 * events. IN_IGNORED and IN_UNMOUNT are always delivered, and tell us the watch is gone. */
+                if ((e->mask & (w->mask|IN_IGNORED|IN_UNMOUNT)) == 0)
+                        return;
+
+                path_inotify_queue(m, s, /* error = */ 0, IN_SET(s->type, PATH_CHANGED, PATH_MODIFIED) && e->wd == s->primary_wd);
+                return;
+        }
+}
+
+static int path_inotify_dispatch(sd_event_source *source, int fd, uint32_t revents, void *userdata) {
+        Manager *m = ASSERT_PTR(userdata);
+        PathSpec *s;
+        int r = 0;
+
+        assert(fd >= 0);
+
+        /* Never return an error from here: this event source is shared by all path specs, and sd-event
+         * would disable it, i.e. silently stop all of them. Instead, fail the affected path specs only. */
+
+        for (;;) {
+                union inotify_event_buffer buffer;
+                ssize_t l;
+
+                l = read(fd, &buffer, sizeof(buffer));
+                if (l < 0) {
+                        if (ERRNO_IS_TRANSIENT(errno))
+                                break;
+
+                        /* We can't tell whose events we lost, hence fail everybody. */
+                        r = log_error_errno(errno, "Failed to read path inotify events: %m");
+                        path_inotify_queue_all(m, r);
+                        break;
+                }
+
+                FOREACH_INOTIFY_EVENT_WARN(e, buffer, l) {
+                        Set *specs;
+
+                        if (e->wd < 0) {
+                                /* Queue overflow, we might have missed events. Let every path spec recheck. */
+                                path_inotify_queue_all(m, /* error = */ 0);
+                                continue;
+                        }
 
-                return log_error_errno(errno, "Failed to read inotify event: %m");
+                        /* Note that inotify might deliver events for a watch even after it was removed,
+                         * because it was queued before the removal. Let's ignore this here safely. */
+                        specs = hashmap_get(m->path_inotify_wd_specs, INT_TO_PTR(e->wd));
+                        SET_FOREACH(s, specs)
+                                path_inotify_queue_event(m, s, e);
+                }
         }
 
-        if (IN_SET(s->type, PATH_CHANGED, PATH_MODIFIED))
-                FOREACH_INOTIFY_EVENT_WARN(e, buffer, l)
-                        if (s->primary_wd == e->wd)
-                                return 1;
+        /* Dispatch only after reading all events, so that each path spec is handled once, even if many
+         * events were queued for it. Note that handlers might unwatch other path specs, which then also
+         * drops them from the queue. */
+        while ((s = m->path_inotify_pending)) {
+                bool changed = s->pending_changed;
+                int error = s->pending_error;
+
+                path_inotify_unqueue(m, s);
+
+                assert(s->handler);
+                (void) s->handler(s, error, changed);
+        }
+
+        /* If reading failed and nobody is watching anymore, start over with a new inotify instance the next
+         * time a path spec is watched, rather than waking up for the same error again and again. */
+        if (r < 0 && hashmap_isempty(m->path_inotify_wd_specs))
+                path_inotify_done(m);
 
         return 0;
 }
@@ -273,7 +498,7 @@ static void path_spec_dump(PathSpec *s, FILE *f, const char *prefix) {
 
 void path_spec_done(PathSpec *s) {
         assert(s);
-        assert(s->inotify_fd == -EBADF);
+        assert(s->n_watches == 0);
 
         free(s->path);
 }
@@ -454,7 +679,7 @@ static int path_watch(Path *p) {
         assert(p);
 
         LIST_FOREACH(spec, s, p->specs) {
-                r = path_spec_watch(s, path_dispatch_io);
+                r = path_spec_watch(s, path_dispatch_spec);
                 if (r < 0)
                         return r;
         }
@@ -765,41 +990,24 @@ static const char *path_sub_state_to_string(Unit *u) {
         return path_state_to_string(p->state);
 }
 
-static int path_dispatch_io(sd_event_source *source, int fd, uint32_t revents, void *userdata) {
-        PathSpec *s = ASSERT_PTR(userdata), *found = NULL;
+static int path_dispatch_spec(PathSpec *s, int error, bool changed) {
         Path *p = ASSERT_PTR(PATH(s->unit));
-        int changed;
-
-        assert(fd >= 0);
 
         if (!IN_SET(p->state, PATH_WAITING, PATH_RUNNING))
                 return 0;
 
-        LIST_FOREACH(spec, i, p->specs)
-                if (path_spec_owns_inotify_fd(i, fd)) {
-                        found = i;
-                        break;
-                }
-
-        if (!found) {
-                log_error("Got event on unknown fd.");
-                goto fail;
+        if (error < 0) {
+                log_unit_error_errno(UNIT(p), error, "Failed to read inotify events for %s: %m", s->path);
+                path_enter_dead(p, PATH_FAILURE_RESOURCES);
+                return 0;
         }
 
-        changed = path_spec_fd_event(found, revents);
-        if (changed < 0)
-                goto fail;
-
         if (changed)
-                path_enter_running(p, found->path);
+                path_enter_running(p, s->path);
         else
                 path_enter_waiting(p, false, false);
 
         return 0;
-
-fail:
-        path_enter_dead(p, PATH_FAILURE_RESOURCES);
-        return 0;
 }
 
 static void path_trigger_notify_impl(Unit *u, Unit *other, bool on_defer);
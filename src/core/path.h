@@ -17,30 +17,46 @@ typedef enum PathType {
         _PATH_TYPE_INVALID = -EINVAL,
 } PathType;
 
+/* Called with changed == true if the watched path itself was changed or modified, for PATH_CHANGED and
+ * PATH_MODIFIED, and with changed == false for any other event the PathSpec is interested in. If events
+ * could not be read from the shared inotify instance, error is set to the negative errno. */
+typedef int (*path_spec_handler_t)(PathSpec *s, int error, bool changed);
+
+typedef struct PathSpecWatch {
+        int wd;
+        uint32_t mask;
+} PathSpecWatch;
+
 typedef struct PathSpec {
         Unit *unit;
 
         char *path;
 
-        sd_event_source *event_source;
+        path_spec_handler_t handler;
 
         LIST_FIELDS(struct PathSpec, spec);
 
         PathType type;
-        int inotify_fd;
+
+        /* The watches on the shared inotify instance of the manager, and the events we want from each */
+        PathSpecWatch *watches;
+        size_t n_watches;
         int primary_wd;
 
+        /* Events were read for this PathSpec, but it was not dispatched yet */
+        LIST_FIELDS(struct PathSpec, inotify_pending);
+        bool in_inotify_pending;
+        bool pending_changed;
+        int pending_error;
+
         bool previous_exists;
 } PathSpec;
 
-int path_spec_watch(PathSpec *s, sd_event_io_handler_t handler);
+int path_spec_watch(PathSpec *s, path_spec_handler_t handler);
 void path_spec_unwatch(PathSpec *s);
-int path_spec_fd_event(PathSpec *s, uint32_t events);
 void path_spec_done(PathSpec *s);
 
-static inline bool path_spec_owns_inotify_fd(PathSpec *s, int fd) {
-        return s->inotify_fd == fd;
-}
+void path_inotify_done(Manager *m);
 
 typedef enum PathResult {
         PATH_SUCCESS,
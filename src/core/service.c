@@ -115,7 +115,7 @@ static const UnitActiveState state_translation_table_idle[_SERVICE_STATE_MAX] =
         [SERVICE_CLEANING]                   = UNIT_MAINTENANCE,
 };
 
-static int service_dispatch_inotify_io(sd_event_source *source, int fd, uint32_t events, void *userdata);
+static int service_dispatch_pid_file_event(PathSpec *p, int error, bool changed);
 static int service_dispatch_timer(sd_event_source *source, usec_t usec, void *userdata);
 static int service_dispatch_watchdog(sd_event_source *source, usec_t usec, void *userdata);
 static int service_dispatch_exec_io(sd_event_source *source, int fd, uint32_t events, void *userdata);
@@ -3618,7 +3618,7 @@ static int service_watch_pid_file(Service *s) {
 
         log_unit_debug(UNIT(s), "Setting watch for PID file %s", s->pid_file_pathspec->path);
 
-        r = path_spec_watch(s->pid_file_pathspec, service_dispatch_inotify_io);
+        r = path_spec_watch(s->pid_file_pathspec, service_dispatch_pid_file_event);
         if (r < 0) {
                 log_unit_error_errno(UNIT(s), r, "Failed to set a watch for PID file %s: %m", s->pid_file_pathspec->path);
                 service_unwatch_pid_file(s);
@@ -3649,7 +3649,6 @@ static int service_demand_pid_file(Service *s) {
                 /* PATH_CHANGED would not be enough. There are daemons (sendmail) that keep their PID file
                  * open all the time. */
                 .type = PATH_MODIFIED,
-                .inotify_fd = -EBADF,
         };
 
         if (!ps->path)
@@ -3662,19 +3661,18 @@ static int service_demand_pid_file(Service *s) {
         return service_watch_pid_file(s);
 }
 
-static int service_dispatch_inotify_io(sd_event_source *source, int fd, uint32_t events, void *userdata) {
-        PathSpec *p = ASSERT_PTR(userdata);
-        Service *s = ASSERT_PTR(SERVICE(p->unit));
+static int service_dispatch_pid_file_event(PathSpec *p, int error, bool changed) {
+        Service *s = ASSERT_PTR(SERVICE(ASSERT_PTR(p)->unit));
 
-        assert(fd >= 0);
         assert(IN_SET(s->state, SERVICE_START, SERVICE_START_POST));
-        assert(s->pid_file_pathspec);
-        assert(path_spec_owns_inotify_fd(s->pid_file_pathspec, fd));
-
-        log_unit_debug(UNIT(s), "inotify event");
+        assert(s->pid_file_pathspec == p);
 
-        if (path_spec_fd_event(p, events) < 0)
+        if (error < 0) {
+                log_unit_warning_errno(UNIT(s), error, "Failed to read inotify events for PID file %s: %m", p->path);
                 goto fail;
+        }
+
+        log_unit_debug(UNIT(s), "inotify event");
 
         if (service_retry_pid_file(s) == 0)
                 return 0;
@@ -275,38 +275,42 @@ static int transaction_merge_jobs(Transaction *tr, sd_bus_error *e) {
 }
 
 static void transaction_drop_redundant(Transaction *tr) {
-        bool again;
+        Job *j;
 
         /* Goes through the transaction and removes all jobs of the units whose jobs are all noops. If not
-         * all of a unit's jobs are redundant, they are kept. */
+         * all of a unit's jobs are redundant, they are kept.
+         *
+         * Whether a job is redundant only depends on the job itself and the state of its unit, but not on
+         * any other job in the transaction, hence a single pass is sufficient. */
 
         assert(tr);
 
-        do {
-                Job *j;
-
-                again = false;
-
-                HASHMAP_FOREACH(j, tr->jobs) {
-                        bool keep = false;
-
-                        LIST_FOREACH(transaction, k, j)
-                                if (tr->anchor_job == k ||
-                                    !job_type_is_redundant(k->type, unit_active_state(k->unit)) ||
-                                    (k->unit->job && job_type_is_conflicting(k->type, k->unit->job->type))) {
-                                        keep = true;
-                                        break;
-                                }
+        HASHMAP_FOREACH(j, tr->jobs) {
+                bool keep = false;
 
-                        if (!keep) {
-                                log_trace("Found redundant job %s/%s, dropping from transaction.",
-                                          j->unit->id, job_type_to_string(j->type));
-                                transaction_delete_job(tr, j, false);
-                                again = true;
+                LIST_FOREACH(transaction, k, j)
+                        if (tr->anchor_job == k ||
+                            !job_type_is_redundant(k->type, unit_active_state(k->unit)) ||
+                            (k->unit->job && job_type_is_conflicting(k->type, k->unit->job->type))) {
+                                keep = true;
                                 break;
                         }
+
+                if (keep)
+                        continue;
+
+                /* Delete the other jobs of this unit first, so that the only change to the hashmap is the
+                 * removal of the entry we are currently looking at, which is safe while iterating. */
+                while (j->transaction_next) {
+                        log_trace("Found redundant job %s/%s, dropping from transaction.",
+                                  j->unit->id, job_type_to_string(j->transaction_next->type));
+                        transaction_delete_job(tr, j->transaction_next, false);
                 }
-        } while (again);
+
+                log_trace("Found redundant job %s/%s, dropping from transaction.",
+                          j->unit->id, job_type_to_string(j->type));
+                transaction_delete_job(tr, j, false);
+        }
 }
 
 static bool job_matters_to_anchor(Job *job) {
@@ -630,10 +630,18 @@ static void unit_clear_dependencies(Unit *u) {
 
                 for (Unit *other; (other = hashmap_steal_first_key(deps));) {
                         Hashmap *other_deps;
+                        void *dt;
 
-                        HASHMAP_FOREACH(other_deps, other->dependencies)
+                        HASHMAP_FOREACH_KEY(other_deps, dt, other->dependencies) {
                                 hashmap_remove(other_deps, u);
 
+                                /* Hashmaps never shrink, hence release the per-type hashmap once it is
+                                 * empty, so that e.g. a slice doesn't keep the memory for all units it
+                                 * ever contained around forever. */
+                                if (hashmap_isempty(other_deps))
+                                        hashmap_free(hashmap_remove(other->dependencies, dt));
+                        }
+
                         unit_add_to_gc_queue(other);
                 }
 
@@ -5461,6 +5469,8 @@ static void unit_update_dependency_mask(Hashmap *deps, Unit *other, UnitDependen
 
 void unit_remove_dependencies(Unit *u, UnitDependencyMask mask) {
         Hashmap *deps;
+        void *dt;
+
         assert(u);
 
         /* Removes all dependencies u has on other units marked for ownership by 'mask'. */
@@ -5468,7 +5478,7 @@ void unit_remove_dependencies(Unit *u, UnitDependencyMask mask) {
         if (mask == 0)
                 return;
 
-        HASHMAP_FOREACH(deps, u->dependencies) {
+        HASHMAP_FOREACH_KEY(deps, dt, u->dependencies) {
                 bool done;
 
                 do {
@@ -5479,6 +5489,7 @@ void unit_remove_dependencies(Unit *u, UnitDependencyMask mask) {
 
                         HASHMAP_FOREACH_KEY(di.data, other, deps) {
                                 Hashmap *other_deps;
+                                void *other_dt;
 
                                 if (FLAGS_SET(~mask, di.origin_mask))
                                         continue;
@@ -5491,7 +5502,7 @@ void unit_remove_dependencies(Unit *u, UnitDependencyMask mask) {
                                  * too. For that we go through all dependency types on the other unit and
                                  * delete all those which point to us and have the right mask set. */
 
-                                HASHMAP_FOREACH(other_deps, other->dependencies) {
+                                HASHMAP_FOREACH_KEY(other_deps, other_dt, other->dependencies) {
                                         UnitDependencyInfo dj;
 
                                         dj.data = hashmap_get(other_deps, u);
@@ -5500,6 +5511,10 @@ void unit_remove_dependencies(Unit *u, UnitDependencyMask mask) {
 
                                         dj.destination_mask &= ~mask;
                                         unit_update_dependency_mask(other_deps, u, dj);
+
+                                        /* See unit_clear_dependencies() */
+                                        if (hashmap_isempty(other_deps))
+                                                hashmap_free(hashmap_remove(other->dependencies, other_dt));
                                 }
 
                                 unit_add_to_gc_queue(other);
@@ -5512,6 +5527,9 @@ void unit_remove_dependencies(Unit *u, UnitDependencyMask mask) {
                         }
 
                 } while (!done);
+
+                if (hashmap_isempty(deps))
+                        hashmap_free(hashmap_remove(u->dependencies, dt));
         }
 }
 
@@ -13,6 +13,7 @@
 #include "hashmap.h"
 #include "macro.h"
 #include "memory-util.h"
+#include "sort-util.h"
 #include "stat-util.h"
 #include "string-util.h"
 #include "time-util.h"
@@ -23,17 +24,24 @@
 #define DEFAULT_KEEP_FREE_UPPER (uint64_t) (4ULL*1024ULL*1024ULL*1024ULL) /* 4 GiB */
 #define DEFAULT_KEEP_FREE (uint64_t) (1024ULL*1024ULL)                    /* 1 MB */
 
+typedef struct VacuumFile {
+        char *name;
+        usec_t mtime;
+        uint64_t size;
+} VacuumFile;
+
 typedef struct VacuumCandidate {
-        unsigned n_files;
-        char *oldest_file;
-        usec_t oldest_mtime;
+        VacuumFile *files; /* newest first, i.e. the oldest one is at the end */
+        size_t n_files;
 } VacuumCandidate;
 
 static VacuumCandidate* vacuum_candidate_free(VacuumCandidate *c) {
         if (!c)
                 return NULL;
 
-        free(c->oldest_file);
+        FOREACH_ARRAY(f, c->files, c->n_files)
+                free(f->name);
+        free(c->files);
         return mfree(c);
 }
 DEFINE_TRIVIAL_CLEANUP_FUNC(VacuumCandidate*, vacuum_candidate_free);
@@ -44,6 +52,17 @@ static Hashmap* vacuum_candidate_hashmap_free(Hashmap *h) {
 
 DEFINE_TRIVIAL_CLEANUP_FUNC(Hashmap*, vacuum_candidate_hashmap_free);
 
+static int vacuum_file_compare(const VacuumFile *a, const VacuumFile *b) {
+        return -CMP(a->mtime, b->mtime);
+}
+
+static const VacuumFile* vacuum_candidate_oldest(const VacuumCandidate *c) {
+        assert(c);
+        assert(c->n_files > 0);
+
+        return c->files + c->n_files - 1;
+}
+
 static int uid_from_file_name(const char *filename, uid_t *uid) {
         const char *p, *e, *u;
 
@@ -114,8 +133,11 @@ static bool vacuum_necessary(int fd, uint64_t sum, uint64_t keep_free, uint64_t
 }
 
 int coredump_vacuum(int exclude_fd, uint64_t keep_free, uint64_t max_use) {
+        _cleanup_(vacuum_candidate_hashmap_freep) Hashmap *h = NULL;
         _cleanup_closedir_ DIR *d = NULL;
         struct stat exclude_st;
+        uint64_t sum = 0;
+        VacuumCandidate *c;
         int r;
 
         if (keep_free == 0 && max_use == 0)
@@ -140,78 +162,77 @@ int coredump_vacuum(int exclude_fd, uint64_t keep_free, uint64_t max_use) {
                 return log_error_errno(errno, "Can't open coredump directory: %m");
         }
 
-        for (;;) {
-                _cleanup_(vacuum_candidate_hashmap_freep) Hashmap *h = NULL;
-                VacuumCandidate *worst = NULL;
-                uint64_t sum = 0;
+        /* Collect all files once, and then keep track of what we removed, instead of reading the whole
+         * directory again after each removal. */
+        FOREACH_DIRENT(de, d, goto fail) {
+                struct stat st;
+                uid_t uid;
 
-                rewinddir(d);
-
-                FOREACH_DIRENT(de, d, goto fail) {
-                        VacuumCandidate *c;
-                        struct stat st;
-                        uid_t uid;
-                        usec_t t;
+                r = uid_from_file_name(de->d_name, &uid);
+                if (r < 0)
+                        continue;
 
-                        r = uid_from_file_name(de->d_name, &uid);
-                        if (r < 0)
+                if (fstatat(dirfd(d), de->d_name, &st, AT_NO_AUTOMOUNT|AT_SYMLINK_NOFOLLOW) < 0) {
+                        if (errno == ENOENT)
                                 continue;
 
-                        if (fstatat(dirfd(d), de->d_name, &st, AT_NO_AUTOMOUNT|AT_SYMLINK_NOFOLLOW) < 0) {
-                                if (errno == ENOENT)
-                                        continue;
+                        log_warning_errno(errno, "Failed to stat /var/lib/systemd/coredump/%s: %m", de->d_name);
+                        continue;
+                }
 
-                                log_warning_errno(errno, "Failed to stat /var/lib/systemd/coredump/%s: %m", de->d_name);
-                                continue;
-                        }
+                if (!S_ISREG(st.st_mode))
+                        continue;
 
-                        if (!S_ISREG(st.st_mode))
-                                continue;
+                if (exclude_fd >= 0 && stat_inode_same(&exclude_st, &st))
+                        continue;
 
-                        if (exclude_fd >= 0 && stat_inode_same(&exclude_st, &st))
-                                continue;
+                c = hashmap_get(h, UID_TO_PTR(uid));
+                if (!c) {
+                        _cleanup_(vacuum_candidate_freep) VacuumCandidate *n = NULL;
 
-                        r = hashmap_ensure_allocated(&h, NULL);
+                        n = new0(VacuumCandidate, 1);
+                        if (!n)
+                                return log_oom();
+
+                        r = hashmap_ensure_put(&h, NULL, UID_TO_PTR(uid), n);
                         if (r < 0)
                                 return log_oom();
 
-                        t = timespec_load(&st.st_mtim);
+                        c = TAKE_PTR(n);
+                }
+
+                if (!GREEDY_REALLOC(c->files, c->n_files + 1))
+                        return log_oom();
 
-                        c = hashmap_get(h, UID_TO_PTR(uid));
-                        if (c) {
-                                if (t < c->oldest_mtime) {
-                                        r = free_and_strdup_warn(&c->oldest_file, de->d_name);
-                                        if (r < 0)
-                                                return r;
-                                        c->oldest_mtime = t;
-                                }
-                        } else {
-                                _cleanup_(vacuum_candidate_freep) VacuumCandidate *n = NULL;
+                _cleanup_free_ char *name = strdup(de->d_name);
+                if (!name)
+                        return log_oom();
 
-                                n = new0(VacuumCandidate, 1);
-                                if (!n)
-                                        return log_oom();
+                c->files[c->n_files++] = (VacuumFile) {
+                        .name = TAKE_PTR(name),
+                        .mtime = timespec_load(&st.st_mtim),
+                        .size = st.st_blocks * 512,
+                };
 
-                                r = free_and_strdup_warn(&n->oldest_file, de->d_name);
-                                if (r < 0)
-                                        return r;
-                                n->oldest_mtime = t;
+                sum += st.st_blocks * 512;
+        }
 
-                                r = hashmap_put(h, UID_TO_PTR(uid), n);
-                                if (r < 0)
-                                        return log_oom();
+        HASHMAP_FOREACH(c, h)
+                typesafe_qsort(c->files, c->n_files, vacuum_file_compare);
 
-                                c = TAKE_PTR(n);
-                        }
+        for (;;) {
+                _cleanup_free_ char *name = NULL;
+                VacuumCandidate *worst = NULL;
+                VacuumFile *f;
 
-                        c->n_files++;
+                HASHMAP_FOREACH(c, h) {
+                        if (c->n_files == 0)
+                                continue;
 
                         if (!worst ||
                             worst->n_files < c->n_files ||
-                            (worst->n_files == c->n_files && c->oldest_mtime < worst->oldest_mtime))
+                            (worst->n_files == c->n_files && vacuum_candidate_oldest(c)->mtime < vacuum_candidate_oldest(worst)->mtime))
                                 worst = c;
-
-                        sum += st.st_blocks * 512;
                 }
 
                 if (!worst)
@@ -221,13 +242,17 @@ int coredump_vacuum(int exclude_fd, uint64_t keep_free, uint64_t max_use) {
                 if (r <= 0)
                         return r;
 
-                r = unlinkat_deallocate(dirfd(d), worst->oldest_file, 0);
+                f = worst->files + --worst->n_files;
+                name = TAKE_PTR(f->name);
+                sum -= f->size;
+
+                r = unlinkat_deallocate(dirfd(d), name, 0);
                 if (r == -ENOENT)
                         continue;
                 if (r < 0)
-                        return log_error_errno(r, "Failed to remove file %s: %m", worst->oldest_file);
+                        return log_error_errno(r, "Failed to remove file %s: %m", name);
 
-                log_info("Removed old coredump %s.", worst->oldest_file);
+                log_info("Removed old coredump %s.", name);
         }
 
         return 0;
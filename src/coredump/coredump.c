@@ -559,7 +559,9 @@ static int save_external_coredump(
                 log_debug("Limiting core file size to %" PRIu64 " bytes due to cgroup and/or filesystem limits.", max_size);
         }
 
-        r = copy_bytes(input_fd, fd, max_size, 0);
+        /* The kernel writes out pages that are not backed by anything as NUL bytes. Those often make up
+         * large parts of the core dumps of large processes, hence turn them back into holes. */
+        r = copy_bytes(input_fd, fd, max_size, COPY_SPARSE);
         if (r < 0)
                 return log_error_errno(r, "Cannot store coredump of %s (%s): %m",
                                 context->meta[META_ARGV_PID], context->meta[META_COMM]);
@@ -67,7 +67,24 @@ int import_uncompress_detect(ImportCompress *c, const void *data, size_t size) {
         if (memcmp(data, xz_signature, sizeof(xz_signature)) == 0) {
                 lzma_ret xzr;
 
+#if LZMA_VERSION >= 50040002 /* 5.4.0 */
+                /* Images compressed with "xz -T" consist of multiple independently compressed blocks, which
+                 * may be decoded in parallel. For single-block files this behaves like the regular decoder.
+                 *
+                 * We otherwise avoid threads, but this is fine here: the decoder only runs in the short-lived
+                 * import/pull helper processes, import_compress_free() joins the threads via lzma_end(), and
+                 * the only children forked in the meantime (tar, gpg) exec right away. */
+                const lzma_mt mt = {
+                        .flags = LZMA_TELL_UNSUPPORTED_CHECK | LZMA_CONCATENATED,
+                        .threads = MAX(lzma_cputhreads(), 1u),
+                        .memlimit_threading = lzma_physmem() / 4,
+                        .memlimit_stop = UINT64_MAX,
+                };
+
+                xzr = lzma_stream_decoder_mt(&c->xz, &mt);
+#else
                 xzr = lzma_stream_decoder(&c->xz, UINT64_MAX, LZMA_TELL_UNSUPPORTED_CHECK | LZMA_CONCATENATED);
+#endif
                 if (xzr != LZMA_OK)
                         return -EIO;
 
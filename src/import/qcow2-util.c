@@ -60,34 +60,78 @@ static uint32_t HEADER_HEADER_LENGTH(const Header *h) {
         return be32toh(h->header_length);
 }
 
-static int copy_cluster(
-                int sfd, uint64_t soffset,
-                int dfd, uint64_t doffset,
-                uint64_t cluster_size,
-                void *buffer) {
+/* Upper bound for the size of a run of consecutive clusters copied in one go, at least as large as the
+ * largest cluster size we accept */
+#define COPY_RUN_MAX (4U * 1024U * 1024U)
+
+typedef struct CopyRun {
+        uint64_t soffset;
+        uint64_t doffset;
+        uint64_t size;
+} CopyRun;
 
+static int copy_run(int sfd, int dfd, const CopyRun *run, void *buffer) {
         ssize_t l;
         int r;
 
-        r = reflink_range(sfd, soffset, dfd, doffset, cluster_size);
+        assert(run);
+
+        if (run->size == 0)
+                return 0;
+
+        r = reflink_range(sfd, run->soffset, dfd, run->doffset, run->size);
         if (r >= 0)
                 return r;
 
-        l = pread(sfd, buffer, cluster_size, soffset);
+        l = pread(sfd, buffer, run->size, run->soffset);
         if (l < 0)
                 return -errno;
-        if ((uint64_t) l != cluster_size)
+        if ((uint64_t) l != run->size)
                 return -EIO;
 
-        l = pwrite(dfd, buffer, cluster_size, doffset);
+        l = pwrite(dfd, buffer, run->size, run->doffset);
         if (l < 0)
                 return -errno;
-        if ((uint64_t) l != cluster_size)
+        if ((uint64_t) l != run->size)
                 return -EIO;
 
         return 0;
 }
 
+static int copy_cluster(
+                int sfd, uint64_t soffset,
+                int dfd, uint64_t doffset,
+                uint64_t cluster_size,
+                CopyRun *run,
+                void *buffer) {
+
+        int r;
+
+        assert(run);
+
+        /* Clusters are usually allocated in order, hence try to merge adjacent ones into a single run, so
+         * that they are copied with a single read and write rather than one per cluster. */
+        if (run->size > 0 &&
+            run->soffset + run->size == soffset &&
+            run->doffset + run->size == doffset &&
+            run->size + cluster_size <= COPY_RUN_MAX) {
+                run->size += cluster_size;
+                return 0;
+        }
+
+        r = copy_run(sfd, dfd, run, buffer);
+        if (r < 0)
+                return r;
+
+        *run = (CopyRun) {
+                .soffset = soffset,
+                .doffset = doffset,
+                .size = cluster_size,
+        };
+
+        return 0;
+}
+
 static int decompress_cluster(
                 int sfd, uint64_t soffset,
                 int dfd, uint64_t doffset,
@@ -226,8 +270,9 @@ static int verify_header(const Header *header) {
 }
 
 int qcow2_convert(int qcow2_fd, int raw_fd) {
-        _cleanup_free_ void *buffer1 = NULL, *buffer2 = NULL;
+        _cleanup_free_ void *buffer1 = NULL, *buffer2 = NULL, *run_buffer = NULL;
         _cleanup_free_ be64_t *l1_table = NULL, *l2_table = NULL;
+        CopyRun run = {};
         uint64_t sz, i;
         Header header;
         ssize_t l;
@@ -259,6 +304,10 @@ int qcow2_convert(int qcow2_fd, int raw_fd) {
         if (!buffer2)
                 return -ENOMEM;
 
+        run_buffer = malloc(COPY_RUN_MAX);
+        if (!run_buffer)
+                return -ENOMEM;
+
         /* Empty the file if it exists, we rely on zero bits */
         if (ftruncate(raw_fd, 0) < 0)
                 return -errno;
@@ -310,13 +359,14 @@ int qcow2_convert(int qcow2_fd, int raw_fd) {
                                 r = copy_cluster(
                                                 qcow2_fd, data_begin,
                                                 raw_fd, p,
-                                                HEADER_CLUSTER_SIZE(&header), buffer1);
+                                                HEADER_CLUSTER_SIZE(&header),
+                                                &run, run_buffer);
                         if (r < 0)
                                 return r;
                 }
         }
 
-        return 0;
+        return copy_run(qcow2_fd, raw_fd, &run, run_buffer);
 }
 
 int qcow2_detect(int fd) {
@@ -4,9 +4,21 @@
 #include "fuzz-journald.h"
 #include "journald-syslog.h"
 
+static void process_syslog_message(
+                Server *s,
+                char *buf,
+                size_t raw_len,
+                const struct ucred *ucred,
+                const struct timeval *tv,
+                const char *label,
+                size_t label_len) {
+
+        server_process_syslog_message(s, buf, raw_len, ucred, tv, label, label_len);
+}
+
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
         fuzz_setup_logging();
 
-        fuzz_journald_processing_function(data, size, server_process_syslog_message);
+        fuzz_journald_processing_function(data, size, process_syslog_message);
         return 0;
 }
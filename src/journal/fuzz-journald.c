@@ -20,7 +20,7 @@ void dummy_server_init(Server *s, const uint8_t *buffer, size_t size) {
 void fuzz_journald_processing_function(
                 const uint8_t *data,
                 size_t size,
-                void (*f)(Server *s, const char *buf, size_t raw_len, const struct ucred *ucred, const struct timeval *tv, const char *label, size_t label_len)
+                void (*f)(Server *s, char *buf, size_t raw_len, const struct ucred *ucred, const struct timeval *tv, const char *label, size_t label_len)
         ) {
 
         _cleanup_(server_freep) Server *s = NULL;
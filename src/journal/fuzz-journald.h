@@ -5,8 +5,9 @@
 
 void dummy_server_init(Server *s, const uint8_t *buffer, size_t size);
 
+/* The processing function is passed a writable copy of the input, hence it may modify the buffer */
 void fuzz_journald_processing_function(
                 const uint8_t *data,
                 size_t size,
-                void (*f)(Server *s, const char *buf, size_t raw_len, const struct ucred *ucred, const struct timeval *tv, const char *label, size_t label_len)
+                void (*f)(Server *s, char *buf, size_t raw_len, const struct ucred *ucred, const struct timeval *tv, const char *label, size_t label_len)
 );
@@ -3,6 +3,7 @@
 #include "cgroup-util.h"
 #include "errno-util.h"
 #include "journald-client.h"
+#include "memory-util.h"
 #include "nulstr-util.h"
 #include "pcre2-util.h"
 #include "strv.h"
@@ -14,6 +15,8 @@ static void client_set_filtering_patterns(ClientContext *c, Set *allow_list, Set
 
         set_free_and_replace(c->log_filter_allowed_patterns, allow_list);
         set_free_and_replace(c->log_filter_denied_patterns, deny_list);
+        c->log_filter_xattr = mfree(c->log_filter_xattr);
+        c->log_filter_xattr_size = 0;
 }
 
 static int client_parse_log_filter_nulstr(const char *nulstr, size_t len, Set **ret) {
@@ -65,6 +68,11 @@ int client_context_read_log_filter_patterns(ClientContext *c, const char *cgroup
         if (r < 0)
                 return log_debug_errno(r, "Failed to get user.journald_log_filter_patterns xattr for %s: %m", unit_cgroup);
 
+        /* This is called whenever the context is refreshed, hence avoid compiling the patterns again if
+         * they didn't change since the last time. */
+        if (c->log_filter_xattr && memcmp_nn(xattr, xattr_size, c->log_filter_xattr, c->log_filter_xattr_size) == 0)
+                return 0;
+
         const char *xattr_end = xattr + xattr_size;
 
         /* We expect '0xff' to be present in the attribute, even if the lists are empty. We expect the
@@ -95,6 +103,8 @@ int client_context_read_log_filter_patterns(ClientContext *c, const char *cgroup
                 return r;
 
         client_set_filtering_patterns(c, TAKE_PTR(allow_list), TAKE_PTR(deny_list));
+        c->log_filter_xattr = TAKE_PTR(xattr);
+        c->log_filter_xattr_size = xattr_size;
 
         return 0;
 }
@@ -50,6 +50,11 @@
  *    stream connection. This should improve cases where a service process logs immediately before exiting and we
  *    previously had trouble associating the log message with the service.
  *
+ * Metadata that is a property of the unit rather than of the process (invocation ID, log level, extra fields, rate
+ * limits) is shared between all cache entries in the same cgroup: when a new process shows up in a cgroup whose unit
+ * metadata has been read less than 1s ago for another process, it is copied over from that entry rather than read
+ * again from /run. This makes a difference for services that spawn many short-lived processes that all log.
+ *
  * NB: With and without the metadata cache: the implicitly added entry metadata in the journal (with the exception of
  *     UID/PID/GID and SELinux label) must be understood as possibly slightly out of sync (i.e. sometimes slightly older
  *     and sometimes slightly newer than what was current at the log event).
@@ -133,6 +138,7 @@ static int client_context_new(Server *s, pid_t pid, ClientContext **ret) {
                 .log_ratelimit_interval = s->ratelimit_interval,
                 .log_ratelimit_burst = s->ratelimit_burst,
                 .capability_quintet = CAPABILITY_QUINTET_NULL,
+                .unit_metadata_timestamp = USEC_INFINITY,
         };
 
         r = hashmap_ensure_put(&s->client_contexts, NULL, PID_TO_PTR(pid), c);
@@ -143,10 +149,21 @@ static int client_context_new(Server *s, pid_t pid, ClientContext **ret) {
         return 0;
 }
 
+static void client_context_forget_cgroup(Server *s, ClientContext *c) {
+        assert(s);
+        assert(c);
+
+        /* Make sure we are not used anymore as source of the unit metadata of other entries in our cgroup */
+        if (c->cgroup)
+                (void) hashmap_remove_value(s->client_contexts_by_cgroup, c->cgroup, c);
+}
+
 static void client_context_reset(Server *s, ClientContext *c) {
         assert(s);
         assert(c);
 
+        client_context_forget_cgroup(s, c);
+
         c->timestamp = USEC_INFINITY;
 
         c->uid = UID_INVALID;
@@ -184,8 +201,12 @@ static void client_context_reset(Server *s, ClientContext *c) {
 
         c->log_filter_allowed_patterns = set_free(c->log_filter_allowed_patterns);
         c->log_filter_denied_patterns = set_free(c->log_filter_denied_patterns);
+        c->log_filter_xattr = mfree(c->log_filter_xattr);
+        c->log_filter_xattr_size = 0;
 
         c->capability_quintet = CAPABILITY_QUINTET_NULL;
+
+        c->unit_metadata_timestamp = USEC_INFINITY;
 }
 
 static ClientContext* client_context_free(Server *s, ClientContext *c) {
@@ -301,7 +322,9 @@ static int client_context_read_cgroup(Server *s, ClientContext *c, const char *u
         if (streq_ptr(c->cgroup, t))
                 return 0;
 
+        client_context_forget_cgroup(s, c);
         free_and_replace(c->cgroup, t);
+        c->unit_metadata_timestamp = USEC_INFINITY;
 
         (void) cg_path_get_session(c->cgroup, &t);
         free_and_replace(c->session, t);
@@ -508,6 +531,105 @@ static int client_context_read_log_ratelimit_burst(ClientContext *c) {
         return safe_atou(value, &c->log_ratelimit_burst);
 }
 
+static int client_context_copy_extra_fields(ClientContext *c, const ClientContext *source) {
+        _cleanup_free_ struct iovec *iovec = NULL;
+        _cleanup_free_ void *data = NULL;
+        size_t size = 0;
+
+        assert(c);
+        assert(source);
+
+        if (c->extra_fields_mtime == source->extra_fields_mtime)
+                return 0;
+
+        if (source->extra_fields_n_iovec > 0) {
+                /* Each field is stored in the data blob prefixed by its 64-bit size, see above. */
+                FOREACH_ARRAY(i, source->extra_fields_iovec, source->extra_fields_n_iovec)
+                        size += sizeof(uint64_t) + i->iov_len;
+
+                data = memdup(source->extra_fields_data, size);
+                if (!data)
+                        return -ENOMEM;
+
+                iovec = newdup(struct iovec, source->extra_fields_iovec, source->extra_fields_n_iovec);
+                if (!iovec)
+                        return -ENOMEM;
+
+                FOREACH_ARRAY(i, iovec, source->extra_fields_n_iovec)
+                        i->iov_base = (uint8_t*) data + ((uint8_t*) i->iov_base - (uint8_t*) source->extra_fields_data);
+        }
+
+        free_and_replace(c->extra_fields_iovec, iovec);
+        c->extra_fields_n_iovec = source->extra_fields_n_iovec;
+        free_and_replace(c->extra_fields_data, data);
+        c->extra_fields_mtime = source->extra_fields_mtime;
+
+        return 0;
+}
+
+static bool client_context_copy_unit_metadata(Server *s, ClientContext *c, usec_t timestamp) {
+        ClientContext *source;
+
+        assert(s);
+        assert(c);
+
+        if (!c->cgroup || !c->unit)
+                return false;
+
+        source = hashmap_get(s->client_contexts_by_cgroup, c->cgroup);
+        if (!source || source == c)
+                return false;
+
+        /* Only use data that we would consider current if we had read it for this entry ourselves */
+        assert(source->unit_metadata_timestamp != USEC_INFINITY);
+        if (source->unit_metadata_timestamp + REFRESH_USEC < timestamp)
+                return false;
+
+        if (!streq_ptr(source->unit, c->unit) || !streq_ptr(source->user_unit, c->user_unit))
+                return false;
+
+        /* A unit restarted in quick succession gets the same cgroup path back, but a new invocation, whose
+         * settings might differ, too. Hence the invocation ID is always read per context, and only the data
+         * of the same invocation is shared. */
+        if (sd_id128_is_null(c->invocation_id) || !sd_id128_equal(source->invocation_id, c->invocation_id))
+                return false;
+
+        if (client_context_copy_extra_fields(c, source) < 0)
+                return false;
+
+        c->log_level_max = source->log_level_max;
+        c->log_ratelimit_interval = source->log_ratelimit_interval;
+        c->log_ratelimit_burst = source->log_ratelimit_burst;
+        c->unit_metadata_timestamp = source->unit_metadata_timestamp;
+
+        return true;
+}
+
+static void client_context_read_unit_metadata(Server *s, ClientContext *c, usec_t timestamp) {
+        int r;
+
+        assert(s);
+        assert(c);
+
+        /* Only a freshly read invocation ID tells whether the data of other contexts applies to us */
+        r = client_context_read_invocation_id(s, c);
+        if (r >= 0 && client_context_copy_unit_metadata(s, c, timestamp))
+                return;
+
+        (void) client_context_read_log_level_max(s, c);
+        (void) client_context_read_extra_fields(s, c);
+        (void) client_context_read_log_ratelimit_interval(c);
+        (void) client_context_read_log_ratelimit_burst(c);
+
+        if (!c->cgroup || !c->unit)
+                return;
+
+        /* Offer what we just read to other entries in the same cgroup. Failing to do so is not fatal, they
+         * will then just read the data themselves. */
+        c->unit_metadata_timestamp = timestamp;
+        (void) hashmap_ensure_replace(&s->client_contexts_by_cgroup, &path_hash_ops, c->cgroup, c);
+}
+
 static void client_context_really_refresh(
                 Server *s,
                 ClientContext *c,
@@ -531,11 +653,7 @@ static void client_context_really_refresh(
         (void) audit_loginuid_from_pid(&PIDREF_MAKE_FROM_PID(c->pid), &c->loginuid);
 
         (void) client_context_read_cgroup(s, c, unit_id);
-        (void) client_context_read_invocation_id(s, c);
-        (void) client_context_read_log_level_max(s, c);
-        (void) client_context_read_extra_fields(s, c);
-        (void) client_context_read_log_ratelimit_interval(c);
-        (void) client_context_read_log_ratelimit_burst(c);
+        client_context_read_unit_metadata(s, c, timestamp);
 
         c->timestamp = timestamp;
 
@@ -654,8 +772,11 @@ void client_context_flush_all(Server *s) {
         assert(prioq_isempty(s->client_contexts_lru));
         assert(hashmap_isempty(s->client_contexts));
 
+        assert(hashmap_isempty(s->client_contexts_by_cgroup));
+
         s->client_contexts_lru = prioq_free(s->client_contexts_lru);
         s->client_contexts = hashmap_free(s->client_contexts);
+        s->client_contexts_by_cgroup = hashmap_free(s->client_contexts_by_cgroup);
 }
 
 static int client_context_get_internal(
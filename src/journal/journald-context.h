@@ -58,8 +58,12 @@ struct ClientContext {
         usec_t log_ratelimit_interval;
         unsigned log_ratelimit_burst;
 
+        usec_t unit_metadata_timestamp;
+
         Set *log_filter_allowed_patterns;
         Set *log_filter_denied_patterns;
+        char *log_filter_xattr; /* the raw xattr the patterns above were compiled from */
+        size_t log_filter_xattr_size;
 };
 
 int client_context_get(
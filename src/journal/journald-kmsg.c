@@ -26,6 +26,9 @@
 #include "stdio-util.h"
 #include "string-util.h"
 
+/* How many records to read from /dev/kmsg per event loop iteration at most */
+#define KMSG_RECORDS_PER_DISPATCH_MAX 64U
+
 void server_forward_kmsg(
                 Server *s,
                 int priority,
@@ -333,7 +336,12 @@ static int server_read_dev_kmsg(Server *s) {
         if (l == 0)
                 return 0;
         if (l < 0) {
-                if (ERRNO_IS_TRANSIENT(errno) || errno == EPIPE)
+                /* EPIPE means records got overwritten before we read them. The kernel moved our read
+                 * position to the oldest record still available, hence just continue from there. The gap
+                 * is reported based on the sequence numbers in dev_kmsg_record(). */
+                if (errno == EPIPE)
+                        return 1;
+                if (ERRNO_IS_TRANSIENT(errno))
                         return 0;
 
                 return log_ratelimit_error_errno(errno, JOURNAL_LOG_RATELIMIT, "Failed to read from /dev/kmsg: %m");
@@ -381,7 +389,17 @@ static int dispatch_dev_kmsg(sd_event_source *es, int fd, uint32_t revents, void
         if (!(revents & EPOLLIN))
                 log_error("Got invalid event from epoll for /dev/kmsg: %"PRIx32, revents);
 
-        return server_read_dev_kmsg(s);
+        /* Each read() returns a single record. Process a batch of them per wakeup, so that we keep up with
+         * kernel log storms, but stay bounded so that other event sources still get their turn. */
+        for (unsigned i = 0; i < KMSG_RECORDS_PER_DISPATCH_MAX; i++) {
+                int r;
+
+                r = server_read_dev_kmsg(s);
+                if (r <= 0)
+                        return r;
+        }
+
+        return 0;
 }
 
 int server_open_dev_kmsg(Server *s) {
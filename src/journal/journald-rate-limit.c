@@ -1,5 +1,7 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include "sd-json.h"
+
 #include "alloc-util.h"
 #include "hashmap.h"
 #include "journald-rate-limit.h"
@@ -35,6 +37,9 @@ typedef struct JournalRateLimitGroup {
         /* Interval is stored to keep track of when the group expires */
         usec_t interval;
 
+        /* Total number of messages suppressed since the group was created */
+        uint64_t n_suppressed;
+
         JournalRateLimitPool pools[POOLS_MAX];
 } JournalRateLimitGroup;
 
@@ -144,6 +149,30 @@ static int journal_ratelimit_group_acquire(
         return 0;
 }
 
+static int journal_ratelimit_group_requeue(JournalRateLimitGroup *g) {
+        int r;
+
+        assert(g);
+        assert(g->groups_by_id);
+
+        /* Moves the group to the end of the hashmap whenever one of its pools starts a new window. This
+         * keeps the groups ordered by the time their last window began, so that both the expiry check and
+         * the eviction in journal_ratelimit_vacuum() only need to look at the front, and a unit that keeps
+         * logging is not evicted (and thus does not escape rate limiting) ahead of units that went quiet. */
+
+        if (ordered_hashmap_remove_value(g->groups_by_id, g->id, g) != g)
+                return -ENOENT;
+
+        r = ordered_hashmap_put(g->groups_by_id, g->id, g);
+        if (r < 0) {
+                g->groups_by_id = NULL;
+                journal_ratelimit_group_free(g);
+                return r;
+        }
+
+        return 0;
+}
+
 static unsigned burst_modulate(unsigned burst, uint64_t available) {
         unsigned k;
 
@@ -209,14 +238,7 @@ int journal_ratelimit_test(
 
         p = &g->pools[priority_map[priority]];
 
-        if (p->begin <= 0) {
-                p->suppressed = 0;
-                p->num = 1;
-                p->begin = ts;
-                return 1;
-        }
-
-        if (usec_add(p->begin, rl_interval) < ts) {
+        if (p->begin <= 0 || usec_add(p->begin, rl_interval) < ts) {
                 unsigned s;
 
                 s = p->suppressed;
@@ -224,6 +246,10 @@ int journal_ratelimit_test(
                 p->num = 1;
                 p->begin = ts;
 
+                r = journal_ratelimit_group_requeue(g);
+                if (r < 0)
+                        return r;
+
                 return 1 + s;
         }
 
@@ -233,5 +259,39 @@ int journal_ratelimit_test(
         }
 
         p->suppressed++;
+        g->n_suppressed++;
+        return 0;
+}
+
+int journal_ratelimit_build_json(OrderedHashmap *groups_by_id, sd_json_variant **ret) {
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *v = NULL;
+        JournalRateLimitGroup *g;
+        int r;
+
+        assert(ret);
+
+        ORDERED_HASHMAP_FOREACH(g, groups_by_id) {
+                unsigned suppressed = 0;
+
+                FOREACH_ELEMENT(p, g->pools)
+                        suppressed += p->suppressed;
+
+                r = sd_json_variant_append_arraybo(
+                                &v,
+                                SD_JSON_BUILD_PAIR_STRING("unit", g->id),
+                                SD_JSON_BUILD_PAIR_UNSIGNED("intervalUSec", g->interval),
+                                SD_JSON_BUILD_PAIR_UNSIGNED("suppressed", suppressed),
+                                SD_JSON_BUILD_PAIR_UNSIGNED("suppressedTotal", g->n_suppressed));
+                if (r < 0)
+                        return r;
+        }
+
+        if (!v) {
+                r = sd_json_variant_new_array(&v, NULL, 0);
+                if (r < 0)
+                        return r;
+        }
+
+        *ret = TAKE_PTR(v);
         return 0;
 }
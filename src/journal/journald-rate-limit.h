@@ -3,6 +3,8 @@
 
 #include <inttypes.h>
 
+#include "sd-json.h"
+
 #include "hashmap.h"
 #include "time-util.h"
 
@@ -13,3 +15,5 @@ int journal_ratelimit_test(
                 unsigned rl_burst,
                 int priority,
                 uint64_t available);
+
+int journal_ratelimit_build_json(OrderedHashmap *groups_by_id, sd_json_variant **ret);
@@ -91,6 +91,9 @@
 
 #define IDLE_TIMEOUT_USEC (30*USEC_PER_SEC)
 
+/* Maximum number of datagrams to process per event loop iteration of a datagram socket */
+#define DATAGRAM_BATCH_MAX 16U
+
 #define FAILED_TO_WRITE_ENTRY_RATELIMIT ((const RateLimit) { .interval = 1 * USEC_PER_SEC, .burst = 1 })
 
 static int server_schedule_sync(Server *s, int priority);
@@ -790,6 +793,7 @@ static void server_sync(Server *s, bool wait) {
                                             "Failed to disable sync timer source, ignoring: %m");
 
         s->sync_scheduled = false;
+        s->sync_scheduled_urgent = false;
 }
 
 static void server_do_vacuum(Server *s, JournalStorage *storage, bool verbose) {
@@ -1292,8 +1296,10 @@ void server_dispatch_message(
                                 c->log_ratelimit_burst,
                                 LOG_PRI(priority),
                                 available);
-                if (rl == 0)
+                if (rl == 0) {
+                        s->ratelimit_n_suppressed++;
                         return;
+                }
 
                 /* Write a suppression message if we suppressed something */
                 if (rl > 1)
@@ -1484,14 +1490,8 @@ int server_relinquish_var(Server *s) {
         return 0;
 }
 
-int server_process_datagram(
-                sd_event_source *es,
-                int fd,
-                uint32_t revents,
-                void *userdata) {
-
+static int server_process_datagram_one(Server *s, int fd) {
         size_t label_len = 0, m;
-        Server *s = ASSERT_PTR(userdata);
         struct ucred *ucred = NULL;
         struct timeval tv_buf, *tv = NULL;
         struct cmsghdr *cmsg;
@@ -1525,21 +1525,15 @@ int server_process_datagram(
                 .msg_namelen = sizeof(sa),
         };
 
-        assert(fd == s->native_fd || fd == s->syslog_fd || fd == s->audit_fd);
-
-        if (revents != EPOLLIN)
-                return log_error_errno(SYNTHETIC_ERRNO(EIO),
-                                       "Got invalid event from epoll for datagram fd: %" PRIx32,
-                                       revents);
+        assert(s);
+        assert(fd == s->native_fd || fd == s->syslog_fd);
 
         /* Try to get the right size, if we can. (Not all sockets support SIOCINQ, hence we just try, but don't rely on
          * it.) */
         (void) ioctl(fd, SIOCINQ, &v);
 
-        /* Fix it up, if it is too small. We use the same fixed value as auditd here. Awful! */
-        m = PAGE_ALIGN(MAX3((size_t) v + 1,
-                            (size_t) LINE_MAX,
-                            ALIGN(sizeof(struct nlmsghdr)) + ALIGN((size_t) MAX_AUDIT_MESSAGE_LENGTH)) + 1);
+        /* Fix it up, if it is too small. */
+        m = PAGE_ALIGN(MAX((size_t) v + 1, (size_t) LINE_MAX) + 1);
 
         if (!GREEDY_REALLOC(s->buffer, m))
                 return log_oom();
@@ -1552,11 +1546,11 @@ int server_process_datagram(
         if (n == -ECHRNG) {
                 log_ratelimit_warning_errno(n, JOURNAL_LOG_RATELIMIT,
                                             "Got message with truncated control data (too many fds sent?), ignoring.");
-                return 0;
+                return 1;
         }
         if (n == -EXFULL) {
                 log_ratelimit_warning_errno(n, JOURNAL_LOG_RATELIMIT, "Got message with truncated payload data, ignoring.");
-                return 0;
+                return 1;
         }
         if (n < 0)
                 return log_ratelimit_error_errno(n, JOURNAL_LOG_RATELIMIT, "Failed to receive message: %m");
@@ -1594,7 +1588,9 @@ int server_process_datagram(
                         log_ratelimit_warning(JOURNAL_LOG_RATELIMIT,
                                               "Got file descriptors via syslog socket. Ignoring.");
 
-        } else if (fd == s->native_fd) {
+        } else {
+                assert(fd == s->native_fd);
+
                 if (n > 0 && n_fds == 0)
                         server_process_native_message(s, s->buffer, n, ucred, tv, label, label_len);
                 else if (n == 0 && n_fds == 1)
@@ -1602,21 +1598,122 @@ int server_process_datagram(
                 else if (n_fds > 0)
                         log_ratelimit_warning(JOURNAL_LOG_RATELIMIT,
                                               "Got too many file descriptors via native socket. Ignoring.");
+        }
 
-        } else {
-                assert(fd == s->audit_fd);
+        close_many(fds, n_fds);
+        return 1;
+}
 
-                if (n > 0 && n_fds == 0)
-                        server_process_audit_message(s, s->buffer, n, ucred, &sa, msghdr.msg_namelen);
-                else if (n_fds > 0)
+static int server_process_audit_datagrams(Server *s) {
+        /* Unlike on the native and syslog sockets, where we have to size the buffer for each datagram
+         * individually, audit messages are limited in size by the kernel. Hence we can receive a whole batch
+         * of them with a single recvmmsg() into one preallocated buffer, without risking truncation. Each
+         * slot leaves room for a trailing NUL, and is aligned so that the netlink header is aligned too. */
+        const size_t slot_size = ALIGN(ALIGN(sizeof(struct nlmsghdr)) + ALIGN((size_t) MAX_AUDIT_MESSAGE_LENGTH) + 1);
+
+        CMSG_BUFFER_TYPE(CMSG_SPACE(sizeof(struct ucred))) control[DATAGRAM_BATCH_MAX];
+        union sockaddr_union sa[DATAGRAM_BATCH_MAX];
+        struct iovec iovec[DATAGRAM_BATCH_MAX];
+        struct mmsghdr mmsg[DATAGRAM_BATCH_MAX];
+        int n;
+
+        assert(s);
+
+        if (!GREEDY_REALLOC(s->buffer, slot_size * DATAGRAM_BATCH_MAX))
+                return log_oom();
+
+        /* See server_process_datagram_one() for why the control buffers need to be initialized */
+        zero(control);
+        zero(sa);
+
+        for (size_t i = 0; i < DATAGRAM_BATCH_MAX; i++) {
+                iovec[i] = IOVEC_MAKE(s->buffer + i * slot_size, slot_size - 1);
+                mmsg[i] = (struct mmsghdr) {
+                        .msg_hdr = {
+                                .msg_iov = &iovec[i],
+                                .msg_iovlen = 1,
+                                .msg_control = &control[i],
+                                .msg_controllen = sizeof(control[i]),
+                                .msg_name = &sa[i],
+                                .msg_namelen = sizeof(sa[i]),
+                        },
+                };
+        }
+
+        n = recvmmsg(s->audit_fd, mmsg, DATAGRAM_BATCH_MAX, MSG_DONTWAIT|MSG_CMSG_CLOEXEC, NULL);
+        if (n < 0) {
+                if (ERRNO_IS_TRANSIENT(errno))
+                        return 0;
+
+                return log_ratelimit_error_errno(errno, JOURNAL_LOG_RATELIMIT, "Failed to receive audit messages: %m");
+        }
+
+        for (int i = 0; i < n; i++) {
+                struct msghdr *mh = &mmsg[i].msg_hdr;
+                struct ucred *ucred = NULL;
+                struct cmsghdr *cmsg;
+                char *buffer = iovec[i].iov_base;
+                size_t len = mmsg[i].msg_len;
+
+                if (mh->msg_flags & MSG_CTRUNC) {
+                        /* Something we didn't ask for, possibly file descriptors, which have been closed already. */
+                        cmsg_close_all(mh);
                         log_ratelimit_warning(JOURNAL_LOG_RATELIMIT,
-                                              "Got file descriptors via audit socket. Ignoring.");
+                                              "Got audit message with truncated control data, ignoring.");
+                        continue;
+                }
+                if (mh->msg_flags & MSG_TRUNC) {
+                        log_ratelimit_warning(JOURNAL_LOG_RATELIMIT, "Got audit message with truncated payload data, ignoring.");
+                        continue;
+                }
+
+                CMSG_FOREACH(cmsg, mh)
+                        if (cmsg->cmsg_level == SOL_SOCKET &&
+                            cmsg->cmsg_type == SCM_CREDENTIALS &&
+                            cmsg->cmsg_len == CMSG_LEN(sizeof(struct ucred))) {
+                                assert(!ucred);
+                                ucred = CMSG_TYPED_DATA(cmsg, struct ucred);
+                        }
+
+                /* And a trailing NUL, just in case */
+                buffer[len] = 0;
+
+                if (len > 0)
+                        server_process_audit_message(s, buffer, len, ucred, &sa[i], mh->msg_namelen);
         }
 
-        close_many(fds, n_fds);
+        return n;
+}
+
+int server_process_datagram(
+                sd_event_source *es,
+                int fd,
+                uint32_t revents,
+                void *userdata) {
+
+        Server *s = ASSERT_PTR(userdata);
+        int r = 0;
+
+        if (revents != EPOLLIN)
+                return log_error_errno(SYNTHETIC_ERRNO(EIO),
+                                       "Got invalid event from epoll for datagram fd: %" PRIx32,
+                                       revents);
+
+        /* Under load, going back to the event loop after each datagram means an epoll_wait() round trip per
+         * message. Hence process a couple of queued datagrams in one go. This doesn't starve other sources
+         * any more than before: as long as this source has data queued, it would be dispatched again right
+         * away anyway, unless a source with higher priority is pending. */
+        if (fd == s->audit_fd)
+                r = server_process_audit_datagrams(s);
+        else
+                for (unsigned i = 0; i < DATAGRAM_BATCH_MAX; i++) {
+                        r = server_process_datagram_one(s, fd);
+                        if (r <= 0)
+                                break;
+                }
 
         server_refresh_idle_timer(s);
-        return 0;
+        return MIN(r, 0);
 }
 
 void server_full_flush(Server *s) {
@@ -1965,50 +2062,63 @@ static int server_dispatch_sync(sd_event_source *es, usec_t t, void *userdata) {
 }
 
 static int server_schedule_sync(Server *s, int priority) {
+        bool urgent;
+        usec_t delay;
         int r;
 
         assert(s);
 
-        if (priority <= LOG_CRIT) {
-                /* Immediately sync to disk when this is of priority CRIT, ALERT, EMERG */
-                server_sync(s, /* wait = */ false);
-                return 0;
-        }
-
         if (!s->event || sd_event_get_state(s->event) == SD_EVENT_FINISHED) {
                 /* Shutting down the server? Let's sync immediately. */
                 server_sync(s, /* wait = */ false);
                 return 0;
         }
 
-        if (s->sync_scheduled)
-                return 0;
+        /* Messages of priority CRIT, ALERT, EMERG are synced to disk right away. We don't do that inline
+         * however, but from a timer that elapses immediately, i.e. that is dispatched right after the
+         * current event source. That way all such messages we process in one go (a batch of datagrams, or
+         * all lines read from a stream at once) share a single sync of the journal files, instead of
+         * restarting the offline thread for each of them. */
+        urgent = priority <= LOG_CRIT;
 
-        if (s->sync_interval_usec > 0) {
+        if (urgent ? s->sync_scheduled_urgent : s->sync_scheduled)
+                return 0;
 
-                if (!s->sync_event_source) {
-                        r = sd_event_add_time_relative(
-                                        s->event,
-                                        &s->sync_event_source,
-                                        CLOCK_MONOTONIC,
-                                        s->sync_interval_usec, 0,
-                                        server_dispatch_sync, s);
-                        if (r < 0)
-                                return r;
+        if (urgent)
+                delay = 0;
+        else if (s->sync_interval_usec > 0)
+                delay = s->sync_interval_usec;
+        else
+                return 0;
 
-                        r = sd_event_source_set_priority(s->sync_event_source, SD_EVENT_PRIORITY_IMPORTANT);
-                } else {
-                        r = sd_event_source_set_time_relative(s->sync_event_source, s->sync_interval_usec);
-                        if (r < 0)
-                                return r;
+        if (!s->sync_event_source) {
+                r = sd_event_add_time_relative(
+                                s->event,
+                                &s->sync_event_source,
+                                CLOCK_MONOTONIC,
+                                delay, 0,
+                                server_dispatch_sync, s);
+                if (r < 0)
+                        return r;
 
-                        r = sd_event_source_set_enabled(s->sync_event_source, SD_EVENT_ONESHOT);
-                }
+                r = sd_event_source_set_priority(s->sync_event_source, SD_EVENT_PRIORITY_IMPORTANT);
+        } else {
+                r = sd_event_source_set_time_relative(s->sync_event_source, delay);
                 if (r < 0)
                         return r;
 
-                s->sync_scheduled = true;
+                r = sd_event_source_set_enabled(s->sync_event_source, SD_EVENT_ONESHOT);
         }
+        if (r < 0)
+                return r;
+
+        /* Don't let the default accuracy of 250ms delay urgent syncs. */
+        r = sd_event_source_set_time_accuracy(s->sync_event_source, urgent ? 1 : 0);
+        if (r < 0)
+                return r;
+
+        s->sync_scheduled = true;
+        s->sync_scheduled_urgent = urgent;
 
         return 0;
 }
@@ -108,6 +108,7 @@ struct Server {
         char *buffer;
 
         OrderedHashmap *ratelimit_groups_by_id;
+        uint64_t ratelimit_n_suppressed;
         usec_t sync_interval_usec;
         usec_t ratelimit_interval;
         unsigned ratelimit_burst;
@@ -159,6 +160,7 @@ struct Server {
         bool send_watchdog:1;
         bool sent_notify_ready:1;
         bool sync_scheduled:1;
+        bool sync_scheduled_urgent:1;
 
         char machine_id_field[STRLEN("_MACHINE_ID=") + SD_ID128_STRING_MAX];
         char boot_id_field[STRLEN("_BOOT_ID=") + SD_ID128_STRING_MAX];
@@ -178,6 +180,7 @@ struct Server {
         /* Caching of client metadata */
         Hashmap *client_contexts;
         Prioq *client_contexts_lru;
+        Hashmap *client_contexts_by_cgroup;
 
         usec_t last_cache_pid_flush;
 
@@ -1,5 +1,6 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include "journald-rate-limit.h"
 #include "journald-varlink.h"
 #include "varlink-io.systemd.Journal.h"
 #include "varlink-io.systemd.service.h"
@@ -127,6 +128,27 @@ static int vl_method_relinquish_var(sd_varlink *link, sd_json_variant *parameter
         return sd_varlink_reply(link, NULL);
 }
 
+static int vl_method_describe_rate_limits(sd_varlink *link, sd_json_variant *parameters, sd_varlink_method_flags_t flags, void *userdata) {
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *groups = NULL;
+        Server *s = ASSERT_PTR(userdata);
+        int r;
+
+        assert(link);
+
+        r = sd_varlink_dispatch(link, parameters, /* dispatch_table = */ NULL, /* userdata = */ NULL);
+        if (r != 0)
+                return r;
+
+        r = journal_ratelimit_build_json(s->ratelimit_groups_by_id, &groups);
+        if (r < 0)
+                return r;
+
+        return sd_varlink_replybo(
+                        link,
+                        SD_JSON_BUILD_PAIR_UNSIGNED("suppressedTotal", s->ratelimit_n_suppressed),
+                        SD_JSON_BUILD_PAIR_VARIANT("groups", groups));
+}
+
 static int vl_connect(sd_varlink_server *server, sd_varlink *link, void *userdata) {
         Server *s = ASSERT_PTR(userdata);
 
@@ -168,13 +190,14 @@ int server_open_varlink(Server *s, const char *socket, int fd) {
 
         r = sd_varlink_server_bind_method_many(
                         s->varlink_server,
-                        "io.systemd.Journal.Synchronize",    vl_method_synchronize,
-                        "io.systemd.Journal.Rotate",         vl_method_rotate,
-                        "io.systemd.Journal.FlushToVar",     vl_method_flush_to_var,
-                        "io.systemd.Journal.RelinquishVar",  vl_method_relinquish_var,
-                        "io.systemd.service.Ping",           varlink_method_ping,
-                        "io.systemd.service.SetLogLevel",    varlink_method_set_log_level,
-                        "io.systemd.service.GetEnvironment", varlink_method_get_environment);
+                        "io.systemd.Journal.Synchronize",        vl_method_synchronize,
+                        "io.systemd.Journal.Rotate",             vl_method_rotate,
+                        "io.systemd.Journal.FlushToVar",         vl_method_flush_to_var,
+                        "io.systemd.Journal.RelinquishVar",      vl_method_relinquish_var,
+                        "io.systemd.Journal.DescribeRateLimits", vl_method_describe_rate_limits,
+                        "io.systemd.service.Ping",               varlink_method_ping,
+                        "io.systemd.service.SetLogLevel",        varlink_method_set_log_level,
+                        "io.systemd.service.GetEnvironment",     varlink_method_get_environment);
         if (r < 0)
                 return r;
 
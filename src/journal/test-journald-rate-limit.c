@@ -1,5 +1,7 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include "sd-json.h"
+
 #include "journald-rate-limit.h"
 #include "tests.h"
 
@@ -37,4 +39,34 @@ TEST(journal_ratelimit_test) {
         assert_se(journal_ratelimit_test(&rl, "quux", USEC_PER_SEC, 10, LOG_DEBUG, 0) == 1);
 }
 
+TEST(journal_ratelimit_build_json) {
+        _cleanup_ordered_hashmap_free_ OrderedHashmap *rl = NULL;
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *v = NULL;
+        sd_json_variant *e;
+
+        ASSERT_OK(journal_ratelimit_build_json(rl, &v));
+        ASSERT_TRUE(sd_json_variant_is_array(v));
+        ASSERT_EQ(sd_json_variant_elements(v), 0u);
+        v = sd_json_variant_unref(v);
+
+        for (unsigned i = 0; i < 15; i++) {
+                ASSERT_OK(journal_ratelimit_test(&rl, "hoge", 10 * USEC_PER_SEC, 10, LOG_DEBUG, 0));
+                ASSERT_OK(journal_ratelimit_test(&rl, "hoge", 10 * USEC_PER_SEC, 10, LOG_ERR, 0));
+        }
+        ASSERT_OK_POSITIVE(journal_ratelimit_test(&rl, "foo", 10 * USEC_PER_SEC, 10, LOG_DEBUG, 0));
+
+        ASSERT_OK(journal_ratelimit_build_json(rl, &v));
+        ASSERT_EQ(sd_json_variant_elements(v), 2u);
+
+        ASSERT_NOT_NULL(e = sd_json_variant_by_index(v, 0));
+        ASSERT_STREQ(sd_json_variant_string(sd_json_variant_by_key(e, "unit")), "hoge");
+        ASSERT_EQ(sd_json_variant_unsigned(sd_json_variant_by_key(e, "intervalUSec")), 10 * USEC_PER_SEC);
+        ASSERT_EQ(sd_json_variant_unsigned(sd_json_variant_by_key(e, "suppressed")), 10u);
+        ASSERT_EQ(sd_json_variant_unsigned(sd_json_variant_by_key(e, "suppressedTotal")), 10u);
+
+        ASSERT_NOT_NULL(e = sd_json_variant_by_index(v, 1));
+        ASSERT_STREQ(sd_json_variant_string(sd_json_variant_by_key(e, "unit")), "foo");
+        ASSERT_EQ(sd_json_variant_unsigned(sd_json_variant_by_key(e, "suppressedTotal")), 0u);
+}
+
 DEFINE_TEST_MAIN(LOG_INFO);
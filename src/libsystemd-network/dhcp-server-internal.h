@@ -32,6 +32,7 @@ struct sd_dhcp_server {
         int event_priority;
         sd_event_source *receive_message;
         sd_event_source *receive_broadcast;
+        sd_event_source *save_leases_event_source;
         int fd;
         int fd_raw;
         int fd_broadcast;
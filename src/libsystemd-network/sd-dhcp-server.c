@@ -31,7 +31,7 @@
 #define DHCP_DEFAULT_LEASE_TIME_USEC USEC_PER_HOUR
 #define DHCP_MAX_LEASE_TIME_USEC (USEC_PER_HOUR*12)
 
-static void server_on_lease_change(sd_dhcp_server *server) {
+static void server_save_leases(sd_dhcp_server *server) {
         int r;
 
         assert(server);
@@ -39,6 +39,52 @@ static void server_on_lease_change(sd_dhcp_server *server) {
         r = dhcp_server_save_leases(server);
         if (r < 0)
                 log_dhcp_server_errno(server, r, "Failed to save leases, ignoring: %m");
+}
+
+static int server_on_save_leases(sd_event_source *s, void *userdata) {
+        server_save_leases(ASSERT_PTR(userdata));
+        return 0;
+}
+
+static int server_schedule_save_leases(sd_dhcp_server *server) {
+        int r;
+
+        assert(server);
+        assert(server->event);
+
+        if (!server->save_leases_event_source) {
+                r = sd_event_add_defer(server->event, &server->save_leases_event_source, server_on_save_leases, server);
+                if (r < 0)
+                        return r;
+
+                r = sd_event_source_set_priority(server->save_leases_event_source, SD_EVENT_PRIORITY_IDLE);
+                if (r < 0)
+                        return r;
+
+                (void) sd_event_source_set_description(server->save_leases_event_source, "dhcp-server-save-leases");
+        }
+
+        return sd_event_source_set_enabled(server->save_leases_event_source, SD_EVENT_ONESHOT);
+}
+
+static void server_flush_leases(sd_dhcp_server *server) {
+        assert(server);
+
+        /* Write out the leases now, if saving them is still pending. */
+        if (sd_event_source_get_enabled(server->save_leases_event_source, NULL) > 0)
+                server_save_leases(server);
+
+        server->save_leases_event_source = sd_event_source_disable_unref(server->save_leases_event_source);
+}
+
+static void server_on_lease_change(sd_dhcp_server *server) {
+        assert(server);
+
+        /* The whole lease file is rewritten on each save. Hence, when a burst of requests is received, save
+         * the leases only once after all of them are processed. */
+        if (server->lease_file &&
+            (!server->event || server_schedule_save_leases(server) < 0))
+                server_save_leases(server);
 
         if (server->callback)
                 server->callback(server, SD_DHCP_SERVER_EVENT_LEASE_CHANGED, server->callback_userdata);
@@ -230,6 +276,8 @@ int sd_dhcp_server_attach_event(sd_dhcp_server *server, sd_event *event, int64_t
 int sd_dhcp_server_detach_event(sd_dhcp_server *server) {
         assert_return(server, -EINVAL);
 
+        server_flush_leases(server);
+
         server->event = sd_event_unref(server->event);
 
         return 0;
@@ -288,6 +336,8 @@ int sd_dhcp_server_stop(sd_dhcp_server *server) {
         server->receive_message = sd_event_source_disable_unref(server->receive_message);
         server->receive_broadcast = sd_event_source_disable_unref(server->receive_broadcast);
 
+        server_flush_leases(server);
+
         server->fd_raw = safe_close(server->fd_raw);
         server->fd = safe_close(server->fd);
         server->fd_broadcast = safe_close(server->fd_broadcast);
@@ -109,6 +109,28 @@ static bool lldp_rx_keep_neighbor(sd_lldp_rx *lldp_rx, sd_lldp_neighbor *n) {
 
 static int lldp_rx_start_timer(sd_lldp_rx *lldp_rx, sd_lldp_neighbor *neighbor);
 
+static int lldp_rx_refresh_neighbor(sd_lldp_rx *lldp_rx, sd_lldp_neighbor *old, const triple_timestamp *timestamp) {
+        assert(lldp_rx);
+        assert(old);
+        assert(timestamp);
+
+        /* The neighbor sent the very same data again. Restart the TTL counter, but don't do anything else,
+         * unless our filters changed in the meantime. */
+
+        if (!lldp_rx_keep_neighbor(lldp_rx, old)) {
+                _cleanup_(sd_lldp_neighbor_unrefp) sd_lldp_neighbor *ref = sd_lldp_neighbor_ref(old);
+
+                lldp_neighbor_unlink(old);
+                lldp_rx_callback(lldp_rx, SD_LLDP_RX_EVENT_REMOVED, old);
+                return 0;
+        }
+
+        old->timestamp = *timestamp;
+        lldp_rx_start_timer(lldp_rx, old);
+        lldp_rx_callback(lldp_rx, SD_LLDP_RX_EVENT_REFRESHED, old);
+        return 0;
+}
+
 static int lldp_rx_add_neighbor(sd_lldp_rx *lldp_rx, sd_lldp_neighbor *n) {
         _cleanup_(sd_lldp_neighbor_unrefp) sd_lldp_neighbor *old = NULL;
         bool keep;
@@ -131,13 +153,8 @@ static int lldp_rx_add_neighbor(sd_lldp_rx *lldp_rx, sd_lldp_neighbor *n) {
                         return 0;
                 }
 
-                if (lldp_neighbor_equal(n, old)) {
-                        /* Is this equal, then restart the TTL counter, but don't do anything else. */
-                        old->timestamp = n->timestamp;
-                        lldp_rx_start_timer(lldp_rx, old);
-                        lldp_rx_callback(lldp_rx, SD_LLDP_RX_EVENT_REFRESHED, old);
-                        return 0;
-                }
+                if (lldp_neighbor_equal(n, old))
+                        return lldp_rx_refresh_neighbor(lldp_rx, old, &n->timestamp);
 
                 /* Data changed, remove the old entry, and add a new one */
                 lldp_neighbor_unlink(old);
@@ -173,11 +190,25 @@ finish:
 }
 
 static int lldp_rx_handle_datagram(sd_lldp_rx *lldp_rx, sd_lldp_neighbor *n) {
+        sd_lldp_neighbor *old;
         int r;
 
         assert(lldp_rx);
         assert(n);
 
+        /* Most LLDPDUs are periodic retransmissions of the previous one. If we know a neighbor that sent
+         * exactly the same datagram, then there's no need to parse it again. There are usually only a few
+         * neighbors per link, hence simply compare with all of them. */
+        HASHMAP_FOREACH(old, lldp_rx->neighbor_by_id)
+                if (lldp_neighbor_equal(n, old)) {
+                        r = lldp_rx_refresh_neighbor(lldp_rx, old, &n->timestamp);
+                        if (r < 0)
+                                return log_lldp_rx_errno(lldp_rx, r, "Failed to refresh neighbor. Ignoring.");
+
+                        log_lldp_rx(lldp_rx, "Received LLDP datagram identical to the one known, refreshed neighbor.");
+                        return 0;
+                }
+
         r = lldp_neighbor_parse(n);
         if (r < 0)
                 return r;
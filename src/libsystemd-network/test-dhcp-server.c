@@ -4,13 +4,18 @@
 ***/
 
 #include <errno.h>
+#include <fcntl.h>
 #include <net/if_arp.h>
+#include <unistd.h>
 
 #include "sd-dhcp-server.h"
 #include "sd-event.h"
 
 #include "dhcp-server-internal.h"
+#include "fd-util.h"
+#include "rm-rf.h"
 #include "tests.h"
+#include "tmpfile-util.h"
 
 static void test_pool(struct in_addr *address, unsigned size, int ret) {
         _cleanup_(sd_dhcp_server_unrefp) sd_dhcp_server *server = NULL;
@@ -132,14 +137,20 @@ static void test_message_handler(void) {
                 .s_addr = htobe32(INADDR_LOOPBACK + 42),
         };
         static uint8_t static_lease_client_id[7] = {0x01, 'A', 'B', 'C', 'D', 'E', 'G' };
+        _cleanup_(rm_rf_physical_and_freep) char *tmp = NULL;
+        _cleanup_close_ int dir_fd = -EBADF;
         int r;
 
         log_debug("/* %s */", __func__);
 
+        ASSERT_OK(mkdtemp_malloc(NULL, &tmp));
+        ASSERT_OK_ERRNO(dir_fd = open(tmp, O_DIRECTORY|O_CLOEXEC));
+
         ASSERT_OK(sd_dhcp_server_new(&server, 1));
         ASSERT_OK(sd_dhcp_server_configure_pool(server, &address_lo, 8, 0, 0));
         ASSERT_OK(sd_dhcp_server_set_static_lease(server, &static_lease_address, static_lease_client_id,
                                                   ELEMENTSOF(static_lease_client_id)));
+        ASSERT_OK(sd_dhcp_server_set_lease_file(server, dir_fd, "leases"));
         ASSERT_OK(sd_dhcp_server_attach_event(server, NULL, 0));
         ASSERT_OK(sd_dhcp_server_start(server));
 
@@ -232,6 +243,11 @@ static void test_message_handler(void) {
         test.option_client_id.id[6] = 'G';
         test.option_requested_ip.address = htobe32(INADDR_LOOPBACK + 42);
         ASSERT_OK_EQ(dhcp_server_handle_message(server, (DHCPMessage*)&test, sizeof(test), NULL), DHCP_ACK);
+
+        /* The leases are saved only when the event loop becomes idle. */
+        ASSERT_ERROR_ERRNO(faccessat(dir_fd, "leases", F_OK, 0), ENOENT);
+        ASSERT_OK(sd_event_run(sd_dhcp_server_get_event(server), 0));
+        ASSERT_OK_ERRNO(faccessat(dir_fd, "leases", F_OK, 0));
 }
 
 static uint64_t client_id_hash_helper(sd_dhcp_client_id *id, uint8_t key[HASH_KEY_SIZE]) {
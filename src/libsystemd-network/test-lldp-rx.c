@@ -137,6 +137,18 @@ static void test_receive_basic_packet(sd_event *e) {
         sd_lldp_neighbor_unref(neighbors[0]);
         free(neighbors);
 
+        /* The same frame again only refreshes the neighbor */
+        assert_se(write(test_fd[1], frame, sizeof(frame)) == sizeof(frame));
+        sd_event_run(e, 0);
+        assert_se(lldp_rx_handler_calls == 2);
+        assert_se(sd_lldp_rx_get_neighbors(lldp_rx, &neighbors) == 1);
+
+        assert_se(sd_lldp_neighbor_get_system_name(neighbors[0], &str) == 0);
+        assert_se(streq(str, "SYS"));
+
+        sd_lldp_neighbor_unref(neighbors[0]);
+        free(neighbors);
+
         assert_se(stop_lldp_rx(lldp_rx) == 0);
 }
 
@@ -15,6 +15,7 @@
 #include "bus-message.h"
 #include "capability-util.h"
 #include "fd-util.h"
+#include "pidfd-util.h"
 #include "process-util.h"
 #include "stdio-util.h"
 #include "string-util.h"
@@ -422,6 +423,370 @@ _public_ int sd_bus_list_names(sd_bus *bus, char ***acquired, char ***activatabl
         return 0;
 }
 
+typedef struct BusCredsCacheEntry {
+        sd_bus_creds *creds;  /* Never carries a pidfd, see below */
+        bool has_pidfd;       /* The bus driver sent a pidfd for the peer */
+        uint64_t pidfd_id;    /* The inode ID of that pidfd, or 0 if the kernel doesn't support them */
+} BusCredsCacheEntry;
+
+static BusCredsCacheEntry* bus_creds_cache_entry_free(BusCredsCacheEntry *e) {
+        if (!e)
+                return NULL;
+
+        sd_bus_creds_unref(e->creds);
+        return mfree(e);
+}
+
+DEFINE_TRIVIAL_CLEANUP_FUNC(BusCredsCacheEntry*, bus_creds_cache_entry_free);
+
+DEFINE_PRIVATE_HASH_OPS_WITH_VALUE_DESTRUCTOR(
+                creds_cache_hash_ops,
+                char, string_hash_func, string_compare_func,
+                BusCredsCacheEntry, bus_creds_cache_entry_free);
+
+void bus_creds_cache_flush(sd_bus *bus) {
+        assert(bus);
+
+        bus->creds_cache = ordered_hashmap_free(bus->creds_cache);
+}
+
+static int creds_cache_name_owner_changed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        sd_bus *bus = ASSERT_PTR(sd_bus_message_get_bus(m));
+        const char *name, *old_owner, *new_owner;
+
+        if (sd_bus_message_read(m, "sss", &name, &old_owner, &new_owner) < 0)
+                return 0;
+
+        /* The peer disconnected, its unique name is never going to be used again */
+        if (isempty(new_owner))
+                bus_creds_cache_entry_free(ordered_hashmap_remove(bus->creds_cache, name));
+
+        return 0;
+}
+
+static int creds_cache_match_installed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        sd_bus *bus = ASSERT_PTR(sd_bus_message_get_bus(m));
+        const sd_bus_error *e;
+
+        e = sd_bus_message_get_error(m);
+        if (!e)
+                return 0;
+
+        /* Without the match we'd never learn about peers going away, hence stop caching. Don't fail the
+         * connection over this, as the default handler for sd_bus_add_match_async() would. */
+        log_debug_errno(sd_bus_message_get_errno(m),
+                        "Failed to subscribe to NameOwnerChanged signals, not caching peer credentials: %s",
+                        e->message);
+
+        bus->creds_cache_disabled = true;
+        bus_creds_cache_flush(bus);
+        return 0;
+}
+
+static bool bus_creds_cache_enabled(sd_bus *bus) {
+        int r;
+
+        assert(bus);
+
+        if (bus->creds_cache_disabled)
+                return false;
+
+        /* Cached entries are dropped when we see the NameOwnerChanged signal of the peer going away. Only
+         * subscribe to these if the connection is attached to an event loop: otherwise we can't know the
+         * signals are ever dispatched, and they would pile up in the read queue. */
+        if (!bus->event)
+                return false;
+
+        if (bus->creds_cache_match_added)
+                return true;
+
+        r = sd_bus_add_match_async(
+                        bus,
+                        /* slot= */ NULL,
+                        "type='signal',"
+                        "sender='org.freedesktop.DBus',"
+                        "path='/org/freedesktop/DBus',"
+                        "interface='org.freedesktop.DBus',"
+                        "member='NameOwnerChanged',"
+                        "arg2=''",
+                        creds_cache_name_owner_changed,
+                        creds_cache_match_installed,
+                        /* userdata= */ NULL);
+        if (r < 0) {
+                log_debug_errno(r, "Failed to subscribe to NameOwnerChanged signals, not caching peer credentials: %m");
+                bus->creds_cache_disabled = true;
+                return false;
+        }
+
+        bus->creds_cache_match_added = true;
+        return true;
+}
+
+static int bus_creds_cache_get(sd_bus *bus, const char *name, bool need_pidfd, sd_bus_creds **ret, int *ret_pidfd) {
+        _cleanup_(pidref_done) PidRef pidref = PIDREF_NULL;
+        BusCredsCacheEntry *e;
+        int r;
+
+        assert(bus);
+        assert(name);
+        assert(ret);
+        assert(ret_pidfd);
+
+        e = ordered_hashmap_get(bus->creds_cache, name);
+        if (!e)
+                return 0;
+
+        if (need_pidfd && e->has_pidfd) {
+                /* We don't keep the peer's pidfd around, as that would mean one fd per cached peer. Open a new
+                 * one for the PID instead, but only use it if it refers to the very same process, i.e. if
+                 * the peer didn't exit and its PID was not reused in the meantime. Without pidfd inode IDs we
+                 * can't tell, hence ask the bus driver. */
+                if (e->pidfd_id == 0)
+                        return 0;
+
+                r = pidref_set_pid(&pidref, e->creds->pid);
+                if (r >= 0)
+                        r = pidref_acquire_pidfd_id(&pidref);
+                if (r < 0 || pidref.fd_id != e->pidfd_id) {
+                        bus_creds_cache_entry_free(ordered_hashmap_remove(bus->creds_cache, name));
+                        return 0;
+                }
+        }
+
+        *ret = sd_bus_creds_ref(e->creds);
+        *ret_pidfd = pidref.fd >= 0 ? TAKE_FD(pidref.fd) : -EBADF;
+        return 1;
+}
+
+static void bus_creds_cache_put(sd_bus *bus, sd_bus_creds *c, bool has_pidfd, uint64_t pidfd_id) {
+        _cleanup_(bus_creds_cache_entry_freep) BusCredsCacheEntry *e = NULL;
+        int r;
+
+        assert(bus);
+        assert(c);
+        assert(c->unique_name);
+        assert(c->pidfd < 0);
+
+        e = new(BusCredsCacheEntry, 1);
+        if (!e)
+                return (void) log_oom_debug();
+
+        *e = (BusCredsCacheEntry) {
+                .creds = sd_bus_creds_ref(c),
+                .has_pidfd = has_pidfd,
+                .pidfd_id = pidfd_id,
+        };
+
+        /* Replace a previous entry for the same peer, if we didn't use it above */
+        bus_creds_cache_entry_free(ordered_hashmap_remove(bus->creds_cache, c->unique_name));
+
+        if (ordered_hashmap_size(bus->creds_cache) >= BUS_CREDS_CACHE_MAX)
+                bus_creds_cache_entry_free(ordered_hashmap_steal_first(bus->creds_cache));
+
+        r = ordered_hashmap_ensure_put(&bus->creds_cache, &creds_cache_hash_ops, c->unique_name, e);
+        if (r < 0)
+                return (void) log_debug_errno(r, "Failed to cache credentials of %s, ignoring: %m", c->unique_name);
+
+        TAKE_PTR(e);
+}
+
+static int bus_get_connection_credentials(
+                sd_bus *bus,
+                const char *name,
+                bool need_pidfd,
+                sd_bus_creds **ret,
+                int *ret_pidfd,
+                sd_bus_error *error) {
+
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
+        _cleanup_(sd_bus_creds_unrefp) sd_bus_creds *c = NULL;
+        bool cacheable, has_pidfd;
+        uint64_t pidfd_id = 0;
+        int r;
+
+        assert(bus);
+        assert(name);
+        assert(ret);
+        assert(ret_pidfd);
+
+        /* Returns everything GetConnectionCredentials() tells us about the specified peer, with the pidfd
+         * returned separately. The bus driver determines these credentials when the peer connects, and
+         * unique names are never reused while the bus is running. Hence, for unique names the result is
+         * cached until the peer disconnects, so that services checking the credentials of their callers on
+         * every method call don't have to synchronously ask the bus driver each time. Note that this only
+         * covers what the bus driver reports, everything we augment from /proc is always read fresh.
+         * Well-known names may change owners at any time, and are not cached. */
+
+        cacheable = name[0] == ':' && bus_creds_cache_enabled(bus);
+        if (cacheable) {
+                r = bus_creds_cache_get(bus, name, need_pidfd, ret, ret_pidfd);
+                if (r != 0)
+                        return r;
+        }
+
+        r = sd_bus_call_method(
+                        bus,
+                        "org.freedesktop.DBus",
+                        "/org/freedesktop/DBus",
+                        "org.freedesktop.DBus",
+                        "GetConnectionCredentials",
+                        error,
+                        &reply,
+                        "s",
+                        name);
+        if (r < 0)
+                return r;
+
+        c = bus_creds_new();
+        if (!c)
+                return -ENOMEM;
+
+        c->unique_name = strdup(name);
+        if (!c->unique_name)
+                return -ENOMEM;
+
+        r = sd_bus_message_enter_container(reply, 'a', "{sv}");
+        if (r < 0)
+                return r;
+
+        for (;;) {
+                const char *m;
+
+                r = sd_bus_message_enter_container(reply, 'e', "sv");
+                if (r < 0)
+                        return r;
+                if (r == 0)
+                        break;
+
+                r = sd_bus_message_read(reply, "s", &m);
+                if (r < 0)
+                        return r;
+
+                if (streq(m, "UnixUserID")) {
+                        uint32_t u;
+
+                        r = sd_bus_message_read(reply, "v", "u", &u);
+                        if (r < 0)
+                                return r;
+
+                        c->euid = u;
+                        c->mask |= SD_BUS_CREDS_EUID;
+
+                } else if (streq(m, "ProcessID")) {
+                        uint32_t p;
+
+                        r = sd_bus_message_read(reply, "v", "u", &p);
+                        if (r < 0)
+                                return r;
+
+                        c->pid = p;
+                        c->mask |= SD_BUS_CREDS_PID;
+
+                } else if (streq(m, "LinuxSecurityLabel")) {
+                        const void *p = NULL;
+                        size_t sz = 0;
+
+                        r = sd_bus_message_enter_container(reply, 'v', "ay");
+                        if (r < 0)
+                                return r;
+
+                        r = sd_bus_message_read_array(reply, 'y', &p, &sz);
+                        if (r < 0)
+                                return r;
+
+                        r = free_and_strndup(&c->label, p, sz);
+                        if (r < 0)
+                                return r;
+
+                        c->mask |= SD_BUS_CREDS_SELINUX_CONTEXT;
+
+                        r = sd_bus_message_exit_container(reply);
+                        if (r < 0)
+                                return r;
+                } else if (streq(m, "ProcessFD")) {
+                        int fd;
+
+                        r = sd_bus_message_read(reply, "v", "h", &fd);
+                        if (r < 0)
+                                return r;
+
+                        fd = fcntl(fd, F_DUPFD_CLOEXEC, 3);
+                        if (fd < 0)
+                                return -errno;
+
+                        close_and_replace(c->pidfd, fd);
+                        c->mask |= SD_BUS_CREDS_PIDFD;
+                } else if (streq(m, "UnixGroupIDs")) {
+
+                        /* Note that D-Bus actually only gives us a combined list of primary gid and
+                         * supplementary gids. And we don't know which one the primary one is. We'll take
+                         * the whole shebang hence and use it as the supplementary group list, and not
+                         * initialize the primary gid field. This is slightly incorrect of course, but only
+                         * slightly, as in effect if the primary gid is also listed in the supplementary gid
+                         * it has zero effect. */
+
+                        r = sd_bus_message_enter_container(reply, 'v', "au");
+                        if (r < 0)
+                                return r;
+
+                        r = sd_bus_message_enter_container(reply, 'a', "u");
+                        if (r < 0)
+                                return r;
+
+                        for (;;) {
+                                uint32_t u;
+
+                                r = sd_bus_message_read(reply, "u", &u);
+                                if (r < 0)
+                                        return r;
+                                if (r == 0)
+                                        break;
+
+                                if (!GREEDY_REALLOC(c->supplementary_gids, c->n_supplementary_gids+1))
+                                        return -ENOMEM;
+
+                                c->supplementary_gids[c->n_supplementary_gids++] = (gid_t) u;
+                        }
+
+                        r = sd_bus_message_exit_container(reply);
+                        if (r < 0)
+                                return r;
+
+                        r = sd_bus_message_exit_container(reply);
+                        if (r < 0)
+                                return r;
+
+                        c->mask |= SD_BUS_CREDS_SUPPLEMENTARY_GIDS;
+                } else {
+                        r = sd_bus_message_skip(reply, "v");
+                        if (r < 0)
+                                return r;
+                }
+
+                r = sd_bus_message_exit_container(reply);
+                if (r < 0)
+                        return r;
+        }
+
+        r = sd_bus_message_exit_container(reply);
+        if (r < 0)
+                return r;
+
+        /* Hand out the pidfd separately, so that the creds object can be cached without it */
+        has_pidfd = c->pidfd >= 0;
+        if (has_pidfd)
+                (void) pidfd_get_inode_id(c->pidfd, &pidfd_id);
+
+        *ret_pidfd = TAKE_FD(c->pidfd);
+        c->mask &= ~SD_BUS_CREDS_PIDFD;
+
+        if (cacheable)
+                bus_creds_cache_put(bus, c, has_pidfd, pidfd_id);
+
+        *ret = TAKE_PTR(c);
+        return 0;
+}
+
 _public_ int sd_bus_get_name_creds(
                 sd_bus *bus,
                 const char *name,
@@ -519,19 +884,12 @@ _public_ int sd_bus_get_name_creds(
 
                 if (need_pid + need_uid + need_selinux + need_pidfd + need_gids > 1) {
 
-                        /* If we need more than one of the credentials, then use GetConnectionCredentials() */
+                        _cleanup_(sd_bus_creds_unrefp) sd_bus_creds *cc = NULL;
+                        _cleanup_close_ int pidfd = -EBADF;
 
-                        r = sd_bus_call_method(
-                                        bus,
-                                        "org.freedesktop.DBus",
-                                        "/org/freedesktop/DBus",
-                                        "org.freedesktop.DBus",
-                                        "GetConnectionCredentials",
-                                        &error,
-                                        &reply,
-                                        "s",
-                                        unique ?: name);
+                        /* If we need more than one of the credentials, then use GetConnectionCredentials() */
 
+                        r = bus_get_connection_credentials(bus, unique ?: name, need_pidfd, &cc, &pidfd, &error);
                         if (r < 0) {
 
                                 if (!sd_bus_error_has_name(&error, SD_BUS_ERROR_UNKNOWN_METHOD))
@@ -544,146 +902,54 @@ _public_ int sd_bus_get_name_creds(
                         } else {
                                 need_separate_calls = false;
 
-                                r = sd_bus_message_enter_container(reply, 'a', "{sv}");
-                                if (r < 0)
-                                        return r;
+                                if (need_uid && (cc->mask & SD_BUS_CREDS_EUID)) {
+                                        c->euid = cc->euid;
+                                        c->mask |= SD_BUS_CREDS_EUID;
+                                }
 
-                                for (;;) {
-                                        const char *m;
+                                if (need_pid && (cc->mask & SD_BUS_CREDS_PID)) {
+                                        pidref = PIDREF_MAKE_FROM_PID(cc->pid);
 
-                                        r = sd_bus_message_enter_container(reply, 'e', "sv");
-                                        if (r < 0)
-                                                return r;
-                                        if (r == 0)
-                                                break;
+                                        if (mask & SD_BUS_CREDS_PID) {
+                                                c->pid = cc->pid;
+                                                c->mask |= SD_BUS_CREDS_PID;
+                                        }
+                                }
 
-                                        r = sd_bus_message_read(reply, "s", &m);
+                                if (need_selinux && (cc->mask & SD_BUS_CREDS_SELINUX_CONTEXT)) {
+                                        r = free_and_strdup(&c->label, cc->label);
                                         if (r < 0)
                                                 return r;
 
-                                        if (need_uid && streq(m, "UnixUserID")) {
-                                                uint32_t u;
-
-                                                r = sd_bus_message_read(reply, "v", "u", &u);
-                                                if (r < 0)
-                                                        return r;
-
-                                                c->euid = u;
-                                                c->mask |= SD_BUS_CREDS_EUID;
-
-                                        } else if (need_pid && streq(m, "ProcessID")) {
-                                                uint32_t p;
-
-                                                r = sd_bus_message_read(reply, "v", "u", &p);
-                                                if (r < 0)
-                                                        return r;
-
-                                                if (!pidref_is_set(&pidref))
-                                                        pidref = PIDREF_MAKE_FROM_PID(p);
-
-                                                if (mask & SD_BUS_CREDS_PID) {
-                                                        c->pid = p;
-                                                        c->mask |= SD_BUS_CREDS_PID;
-                                                }
-
-                                        } else if (need_selinux && streq(m, "LinuxSecurityLabel")) {
-                                                const void *p = NULL;
-                                                size_t sz = 0;
-
-                                                r = sd_bus_message_enter_container(reply, 'v', "ay");
-                                                if (r < 0)
-                                                        return r;
-
-                                                r = sd_bus_message_read_array(reply, 'y', &p, &sz);
-                                                if (r < 0)
-                                                        return r;
-
-                                                r = free_and_strndup(&c->label, p, sz);
-                                                if (r < 0)
-                                                        return r;
+                                        c->mask |= SD_BUS_CREDS_SELINUX_CONTEXT;
+                                }
 
-                                                c->mask |= SD_BUS_CREDS_SELINUX_CONTEXT;
+                                if (need_pidfd && pidfd >= 0) {
+                                        pidref_done(&pidref);
+                                        r = pidref_set_pidfd(&pidref, pidfd);
+                                        if (r < 0)
+                                                return r;
 
-                                                r = sd_bus_message_exit_container(reply);
-                                                if (r < 0)
-                                                        return r;
-                                        } else if (need_pidfd && streq(m, "ProcessFD")) {
+                                        if (mask & SD_BUS_CREDS_PIDFD) {
                                                 int fd;
 
-                                                r = sd_bus_message_read(reply, "v", "h", &fd);
-                                                if (r < 0)
-                                                        return r;
-
-                                                pidref_done(&pidref);
-                                                r = pidref_set_pidfd(&pidref, fd);
-                                                if (r < 0)
-                                                        return r;
-
-                                                if (mask & SD_BUS_CREDS_PIDFD) {
-                                                        fd = fcntl(fd, F_DUPFD_CLOEXEC, 3);
-                                                        if (fd < 0)
-                                                                return -errno;
-
-                                                        close_and_replace(c->pidfd, fd);
-                                                        c->mask |= SD_BUS_CREDS_PIDFD;
-                                                }
-                                        } else if (need_gids && streq(m, "UnixGroupIDs")) {
-
-                                                /* Note that D-Bus actually only gives us a combined list of
-                                                 * primary gid and supplementary gids. And we don't know
-                                                 * which one the primary one is. We'll take the whole shebang
-                                                 * hence and use it as the supplementary group list, and not
-                                                 * initialize the primary gid field. This is slightly
-                                                 * incorrect of course, but only slightly, as in effect if
-                                                 * the primary gid is also listed in the supplementary gid
-                                                 * it has zero effect. */
-
-                                                r = sd_bus_message_enter_container(reply, 'v', "au");
-                                                if (r < 0)
-                                                        return r;
-
-                                                r = sd_bus_message_enter_container(reply, 'a', "u");
-                                                if (r < 0)
-                                                        return r;
-
-                                                for (;;) {
-                                                        uint32_t u;
-
-                                                        r = sd_bus_message_read(reply, "u", &u);
-                                                        if (r < 0)
-                                                                return r;
-                                                        if (r == 0)
-                                                                break;
-
-                                                        if (!GREEDY_REALLOC(c->supplementary_gids, c->n_supplementary_gids+1))
-                                                                return -ENOMEM;
-
-                                                        c->supplementary_gids[c->n_supplementary_gids++] = (gid_t) u;
-                                                }
-
-                                                r = sd_bus_message_exit_container(reply);
-                                                if (r < 0)
-                                                        return r;
-
-                                                r = sd_bus_message_exit_container(reply);
-                                                if (r < 0)
-                                                        return r;
-
-                                                c->mask |= SD_BUS_CREDS_SUPPLEMENTARY_GIDS;
-                                        } else {
-                                                r = sd_bus_message_skip(reply, "v");
-                                                if (r < 0)
-                                                        return r;
-                                        }
+                                                fd = fcntl(pidfd, F_DUPFD_CLOEXEC, 3);
+                                                if (fd < 0)
+                                                        return -errno;
 
-                                        r = sd_bus_message_exit_container(reply);
-                                        if (r < 0)
-                                                return r;
+                                                close_and_replace(c->pidfd, fd);
+                                                c->mask |= SD_BUS_CREDS_PIDFD;
+                                        }
                                 }
 
-                                r = sd_bus_message_exit_container(reply);
-                                if (r < 0)
-                                        return r;
+                                if (need_gids && (cc->mask & SD_BUS_CREDS_SUPPLEMENTARY_GIDS)) {
+                                        c->supplementary_gids = newdup(gid_t, cc->supplementary_gids, cc->n_supplementary_gids);
+                                        if (!c->supplementary_gids && cc->n_supplementary_gids > 0)
+                                                return -ENOMEM;
+
+                                        c->n_supplementary_gids = cc->n_supplementary_gids;
+                                        c->mask |= SD_BUS_CREDS_SUPPLEMENTARY_GIDS;
+                                }
 
                                 if (need_pid && !pidref_is_set(&pidref))
                                         return -EPROTO;
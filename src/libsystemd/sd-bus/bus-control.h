@@ -7,3 +7,5 @@ int bus_add_match_internal(sd_bus *bus, const char *match, uint64_t timeout_usec
 int bus_add_match_internal_async(sd_bus *bus, sd_bus_slot **ret, const char *match, sd_bus_message_handler_t callback, void *userdata, uint64_t timeout_usec);
 
 int bus_remove_match_internal(sd_bus *bus, const char *match);
+
+void bus_creds_cache_flush(sd_bus *bus);
@@ -648,5 +648,9 @@ int bus_message_pcap_frame(sd_bus_message *m, size_t snaplen, FILE *f) {
         /* trailing block length */
         fwrite(&length, 1, sizeof(uint32_t), f);
 
-        return fflush_and_check(f);
+        /* Flushing is left to the caller, so that frames of a burst of messages are written out together. */
+        if (ferror(f))
+                return errno_or_else(EIO);
+
+        return 0;
 }
@@ -239,6 +239,12 @@ struct sd_bus {
         OrderedHashmap *reply_callbacks;
         LIST_HEAD(struct filter_callback, filter_callbacks);
 
+        /* Credentials of peers as reported by the bus driver, keyed by unique name, dropped again when the
+         * peer disconnects */
+        OrderedHashmap *creds_cache;
+        bool creds_cache_match_added;
+        bool creds_cache_disabled;
+
         Hashmap *nodes;
         Set *vtable_methods;
         Set *vtable_properties;
@@ -353,6 +359,9 @@ struct sd_bus {
 
 #define BUS_FDS_MAX 1024
 
+/* How many peers to cache the credentials of */
+#define BUS_CREDS_CACHE_MAX 64U
+
 #define BUS_EXEC_ARGV_MAX 256
 
 bool interface_name_is_valid(const char *p) _pure_;
@@ -53,11 +53,20 @@ static bool BUS_MATCH_IS_COMPARE(enum bus_match_node_type t) {
 }
 
 static bool BUS_MATCH_CAN_HASH(enum bus_match_node_type t) {
-        return (t >= BUS_MATCH_MESSAGE_TYPE && t <= BUS_MATCH_PATH) ||
+        return (t >= BUS_MATCH_MESSAGE_TYPE && t <= BUS_MATCH_PATH_NAMESPACE) ||
                 (t >= BUS_MATCH_ARG && t <= BUS_MATCH_ARG_LAST) ||
+                (t >= BUS_MATCH_ARG_NAMESPACE && t <= BUS_MATCH_ARG_NAMESPACE_LAST) ||
                 (t >= BUS_MATCH_ARG_HAS && t <= BUS_MATCH_ARG_HAS_LAST);
 }
 
+static char BUS_MATCH_NAMESPACE_SEPARATOR(enum bus_match_node_type t) {
+        if (t == BUS_MATCH_PATH_NAMESPACE)
+                return '/';
+        if (t >= BUS_MATCH_ARG_NAMESPACE && t <= BUS_MATCH_ARG_NAMESPACE_LAST)
+                return '.';
+        return 0;
+}
+
 static void bus_match_node_free(struct bus_match_node *node) {
         assert(node);
         assert(node->parent);
@@ -235,6 +244,74 @@ static bool value_node_same(
         }
 }
 
+static int bus_match_run_namespace(
+                sd_bus *bus,
+                struct bus_match_node *node,
+                sd_bus_message *m,
+                const char *value,
+                char separator) {
+
+        _cleanup_free_ char *heap = NULL;
+        size_t n, last = SIZE_MAX;
+        char *buf;
+        int r;
+
+        assert(node);
+        assert(value);
+
+        /* The value nodes of namespace matches are hashed by the namespace string, too. A namespace
+         * matches a value if it is identical to it, or if it is a prefix of it that ends right before or
+         * right after a separator (see simple_pattern_check()). Hence, rather than testing each value node,
+         * look up every such prefix of the value, of which there are only as many as it has components. */
+
+        /* The prefixes are terminated in place, hence work on a copy, which is kept on the stack unless the
+         * value is unusually long, so that dispatching doesn't allocate. */
+        n = strlen(value);
+        if (n < PATH_MAX)
+                buf = strndupa_safe(value, n);
+        else {
+                heap = strndup(value, n);
+                if (!heap)
+                        return -ENOMEM;
+                buf = heap;
+        }
+
+        for (size_t i = 0; i <= n; i++) {
+                if (i < n && buf[i] != separator)
+                        continue;
+
+                for (size_t l = i; l <= MIN(i + 1, n); l++) {
+                        struct bus_match_node *found;
+                        char saved;
+
+                        /* Don't look up the same prefix twice, if two separators follow each other, or if
+                         * the value ends in one. */
+                        if (l == last)
+                                continue;
+                        last = l;
+
+                        saved = buf[l];
+                        buf[l] = 0;
+                        found = hashmap_get(node->compare.children, buf);
+                        buf[l] = saved;
+
+                        if (!found)
+                                continue;
+
+                        r = bus_match_run(bus, found, m);
+                        if (r != 0)
+                                return r;
+
+                        /* A callback might have removed matches, and with them the nodes we are iterating
+                         * through, hence stop here, like bus_match_run() does for the other node types. */
+                        if (bus && bus->match_callbacks_modified)
+                                return 0;
+                }
+        }
+
+        return 0;
+}
+
 int bus_match_run(
                 sd_bus *bus,
                 struct bus_match_node *node,
@@ -380,7 +457,13 @@ int bus_match_run(
 
                 /* Lookup via hash table, nice! So let's jump directly. */
 
-                if (test_str)
+                if (test_str && BUS_MATCH_NAMESPACE_SEPARATOR(node->type) != 0) {
+                        r = bus_match_run_namespace(bus, node, m, test_str, BUS_MATCH_NAMESPACE_SEPARATOR(node->type));
+                        if (r != 0)
+                                return r;
+
+                        found = NULL;
+                } else if (test_str)
                         found = hashmap_get(node->compare.children, test_str);
                 else if (test_strv) {
                         STRV_FOREACH(i, test_strv) {
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
 #include <endian.h>
+#include <limits.h>
 #include <poll.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -1214,38 +1215,58 @@ int bus_socket_take_fd(sd_bus *b) {
         return bus_socket_start_auth(b);
 }
 
-int bus_socket_write_message(sd_bus *bus, sd_bus_message *m, size_t *idx) {
+int bus_socket_write_messages(sd_bus *bus, sd_bus_message **messages, size_t n_messages, size_t *idx) {
+        sd_bus_message *m;
         struct iovec *iov;
+        size_t n_iovec = 0, n = 0;
         ssize_t k;
-        size_t n;
         unsigned j;
         int r;
 
         assert(bus);
-        assert(m);
+        assert(messages);
+        assert(n_messages > 0);
         assert(idx);
         assert(IN_SET(bus->state, BUS_RUNNING, BUS_HELLO));
 
+        /* Writes out the specified messages back to back with a single syscall, starting at offset *idx
+         * into the first one. *idx is increased by the number of bytes written, and may hence end up
+         * beyond the end of the first message. */
+
+        m = messages[0];
         if (*idx >= BUS_MESSAGE_SIZE(m))
                 return 0;
 
-        r = bus_message_setup_iovec(m);
-        if (r < 0)
-                return r;
+        for (; n < n_messages; n++) {
+                /* File descriptors are sent along with the first byte of the message they belong to, hence
+                 * only the first message we write may carry any. */
+                if (n > 0 && messages[n]->n_fds > 0)
+                        break;
+
+                r = bus_message_setup_iovec(messages[n]);
+                if (r < 0)
+                        return r;
+
+                if (n > 0 && n_iovec + messages[n]->n_iovec > IOV_MAX)
+                        break;
+
+                n_iovec += messages[n]->n_iovec;
+        }
 
-        n = m->n_iovec * sizeof(struct iovec);
-        iov = newa(struct iovec, n);
-        memcpy_safe(iov, m->iovec, n);
+        /* iovec_advance() modifies the array, hence work on a copy */
+        iov = newa(struct iovec, n_iovec);
+        for (size_t i = 0, o = 0; i < n; o += messages[i]->n_iovec, i++)
+                memcpy_safe(iov + o, messages[i]->iovec, messages[i]->n_iovec * sizeof(struct iovec));
 
         j = 0;
         iovec_advance(iov, &j, *idx);
 
         if (bus->prefer_writev)
-                k = writev(bus->output_fd, iov, m->n_iovec);
+                k = writev(bus->output_fd, iov, n_iovec);
         else {
                 struct msghdr mh = {
                         .msg_iov = iov,
-                        .msg_iovlen = m->n_iovec,
+                        .msg_iovlen = n_iovec,
                 };
 
                 if (m->n_fds > 0 && *idx == 0) {
@@ -1263,7 +1284,7 @@ int bus_socket_write_message(sd_bus *bus, sd_bus_message *m, size_t *idx) {
                 k = sendmsg(bus->output_fd, &mh, MSG_DONTWAIT|MSG_NOSIGNAL);
                 if (k < 0 && errno == ENOTSOCK) {
                         bus->prefer_writev = true;
-                        k = writev(bus->output_fd, iov, m->n_iovec);
+                        k = writev(bus->output_fd, iov, n_iovec);
                 }
         }
 
@@ -223,6 +223,8 @@ static sd_bus* bus_free(sd_bus *b) {
         ordered_hashmap_free(b->reply_callbacks);
         prioq_free(b->reply_callbacks_prioq);
 
+        bus_creds_cache_flush(b);
+
         assert(b->match_callbacks.type == BUS_MATCH_ROOT);
         bus_match_free(&b->match_callbacks);
 
@@ -1810,6 +1812,8 @@ _public_ void sd_bus_close(sd_bus *bus) {
          * the bus object and the bus may be freed */
         bus_reset_queues(bus);
 
+        bus_creds_cache_flush(bus);
+
         bus_close_fds(bus);
 }
 
@@ -1843,6 +1847,9 @@ void bus_enter_closing(sd_bus *bus) {
         if (!IN_SET(bus->state, BUS_WATCH_BIND, BUS_OPENING, BUS_AUTHENTICATING, BUS_HELLO, BUS_RUNNING))
                 return;
 
+        /* We won't learn about peers disconnecting anymore */
+        bus_creds_cache_flush(bus);
+
         bus_set_state(bus, BUS_CLOSING);
 }
 
@@ -2044,70 +2051,85 @@ int bus_seal_synthetic_message(sd_bus *b, sd_bus_message *m) {
         return sd_bus_message_seal(m, UINT32_MAX, 0);
 }
 
-static int bus_write_message(sd_bus *bus, sd_bus_message *m, size_t *idx) {
+static void bus_log_sent_message(sd_bus_message *m) {
+        assert(m);
+
+        log_debug("Sent message type=%s sender=%s destination=%s path=%s interface=%s member=%s"
+                  " cookie=%" PRIu64 " reply_cookie=%" PRIu64
+                  " signature=%s error-name=%s error-message=%s",
+                  bus_message_type_to_string(m->header->type),
+                  strna(sd_bus_message_get_sender(m)),
+                  strna(sd_bus_message_get_destination(m)),
+                  strna(sd_bus_message_get_path(m)),
+                  strna(sd_bus_message_get_interface(m)),
+                  strna(sd_bus_message_get_member(m)),
+                  BUS_MESSAGE_COOKIE(m),
+                  m->reply_cookie,
+                  strna(m->root_container.signature),
+                  strna(m->error.name),
+                  strna(m->error.message));
+}
+
+static int bus_write_messages(sd_bus *bus, sd_bus_message **messages, size_t n_messages, size_t *idx) {
+        size_t begin, end = 0;
         int r;
 
         assert(bus);
-        assert(m);
+        assert(messages);
+        assert(idx);
 
-        r = bus_socket_write_message(bus, m, idx);
+        begin = *idx;
+
+        r = bus_socket_write_messages(bus, messages, n_messages, idx);
         if (r <= 0)
                 return r;
 
-        if (*idx >= BUS_MESSAGE_SIZE(m))
-                log_debug("Sent message type=%s sender=%s destination=%s path=%s interface=%s member=%s"
-                          " cookie=%" PRIu64 " reply_cookie=%" PRIu64
-                          " signature=%s error-name=%s error-message=%s",
-                          bus_message_type_to_string(m->header->type),
-                          strna(sd_bus_message_get_sender(m)),
-                          strna(sd_bus_message_get_destination(m)),
-                          strna(sd_bus_message_get_path(m)),
-                          strna(sd_bus_message_get_interface(m)),
-                          strna(sd_bus_message_get_member(m)),
-                          BUS_MESSAGE_COOKIE(m),
-                          m->reply_cookie,
-                          strna(m->root_container.signature),
-                          strna(m->error.name),
-                          strna(m->error.message));
+        /* Log all messages that have been completed by this write */
+        for (size_t i = 0; i < n_messages; i++) {
+                end += BUS_MESSAGE_SIZE(messages[i]);
+                if (end > *idx)
+                        break;
+
+                if (end > begin)
+                        bus_log_sent_message(messages[i]);
+        }
 
         return r;
 }
 
 static int dispatch_wqueue(sd_bus *bus) {
-        int r, ret = 0;
+        size_t n_written = 0;
+        int r = 0, ret = 0;
 
         assert(bus);
         assert(IN_SET(bus->state, BUS_RUNNING, BUS_HELLO));
 
-        while (bus->wqueue_size > 0) {
+        while (n_written < bus->wqueue_size) {
 
-                r = bus_write_message(bus, bus->wqueue[0], &bus->windex);
-                if (r < 0)
-                        return r;
-                else if (r == 0)
-                        /* Didn't do anything this time */
-                        return ret;
-                else if (bus->windex >= BUS_MESSAGE_SIZE(bus->wqueue[0])) {
-                        /* Fully written. Let's drop the entry from
-                         * the queue.
-                         *
-                         * This isn't particularly optimized, but
-                         * well, this is supposed to be our worst-case
-                         * buffer only, and the socket buffer is
-                         * supposed to be our primary buffer, and if
-                         * it got full, then all bets are off
-                         * anyway. */
-
-                        bus->wqueue_size--;
-                        bus_message_unref_queued(bus->wqueue[0], bus);
-                        memmove(bus->wqueue, bus->wqueue + 1, sizeof(sd_bus_message*) * bus->wqueue_size);
-                        bus->windex = 0;
+                /* Write as many queued messages as possible in one go */
+                r = bus_write_messages(bus, bus->wqueue + n_written, bus->wqueue_size - n_written, &bus->windex);
+                if (r <= 0)
+                        /* Failed, or didn't do anything this time */
+                        break;
+
+                /* Release all entries that have been fully written now */
+                while (n_written < bus->wqueue_size &&
+                       bus->windex >= BUS_MESSAGE_SIZE(bus->wqueue[n_written])) {
+                        bus->windex -= BUS_MESSAGE_SIZE(bus->wqueue[n_written]);
+                        bus_message_unref_queued(bus->wqueue[n_written], bus);
+                        n_written++;
 
                         ret = 1;
                 }
         }
 
-        return ret;
+        /* Drop the written entries from the queue, all at once rather than one by one. */
+        if (n_written > 0) {
+                bus->wqueue_size -= n_written;
+                memmove(bus->wqueue, bus->wqueue + n_written, sizeof(sd_bus_message*) * bus->wqueue_size);
+        }
+
+        return r < 0 ? r : ret;
 }
 
 static int bus_read_message(sd_bus *bus) {
@@ -2211,7 +2233,7 @@ _public_ int sd_bus_send(sd_bus *bus, sd_bus_message *_m, uint64_t *cookie) {
         if (IN_SET(bus->state, BUS_RUNNING, BUS_HELLO) && bus->wqueue_size <= 0) {
                 size_t idx = 0;
 
-                r = bus_write_message(bus, m, &idx);
+                r = bus_write_messages(bus, &m, 1, &idx);
                 if (ERRNO_IS_NEG_DISCONNECT(r)) {
                         bus_enter_closing(bus);
                         return -ECONNRESET;
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include "sd-bus.h"
+#include "sd-event.h"
+
+#include "bus-internal.h"
+#include "fd-util.h"
+#include "pidfd-util.h"
+#include "process-util.h"
+#include "tests.h"
+#include "time-util.h"
+
+static int open_bus(bool system, sd_bus **ret) {
+        return system ? sd_bus_open_system(ret) : sd_bus_open_user(ret);
+}
+
+TEST(creds_cache) {
+        _cleanup_(sd_event_unrefp) sd_event *event = NULL;
+        _cleanup_(sd_bus_flush_close_unrefp) sd_bus *a = NULL, *b = NULL;
+        bool use_system_bus = false;
+        const char *unique;
+        usec_t end;
+        int r;
+
+        r = open_bus(/* system = */ false, &a);
+        if (IN_SET(r, -ECONNREFUSED, -ENOENT, -ENOMEDIUM)) {
+                r = open_bus(/* system = */ true, &a);
+                if (IN_SET(r, -ECONNREFUSED, -ENOENT))
+                        return (void) log_tests_skipped("Failed to connect to bus");
+                use_system_bus = true;
+        }
+        ASSERT_OK(r);
+        ASSERT_OK(open_bus(use_system_bus, &b));
+
+        ASSERT_OK(sd_bus_get_unique_name(b, &unique));
+
+        /* Without an event loop nothing would dispatch the NameOwnerChanged signals, hence nothing is cached */
+        for (unsigned i = 0; i < 2; i++) {
+                _cleanup_(sd_bus_creds_unrefp) sd_bus_creds *creds = NULL;
+
+                ASSERT_OK(sd_bus_get_name_creds(a, unique, SD_BUS_CREDS_EUID|SD_BUS_CREDS_PID, &creds));
+        }
+        ASSERT_TRUE(ordered_hashmap_isempty(a->creds_cache));
+
+        ASSERT_OK(sd_event_new(&event));
+        ASSERT_OK(sd_bus_attach_event(a, event, SD_EVENT_PRIORITY_NORMAL));
+
+        for (unsigned i = 0; i < 3; i++) {
+                _cleanup_(sd_bus_creds_unrefp) sd_bus_creds *creds = NULL;
+                _cleanup_close_ int pidfd = -EBADF;
+                uid_t euid;
+                pid_t pid;
+
+                ASSERT_OK(sd_bus_get_name_creds(a, unique, SD_BUS_CREDS_EUID|SD_BUS_CREDS_PID|SD_BUS_CREDS_PIDFD, &creds));
+
+                ASSERT_OK(sd_bus_creds_get_euid(creds, &euid));
+                ASSERT_EQ(euid, geteuid());
+                ASSERT_OK(sd_bus_creds_get_pid(creds, &pid));
+                ASSERT_EQ(pid, getpid_cached());
+
+                /* Cached or not, we always get a pidfd of our own, referring to the peer */
+                r = sd_bus_creds_get_pidfd_dup(creds, &pidfd);
+                if (r >= 0) {
+                        pid_t p;
+
+                        ASSERT_OK(pidfd_get_pid(pidfd, &p));
+                        ASSERT_EQ(p, getpid_cached());
+                } else
+                        ASSERT_ERROR(r, ENODATA);
+
+                ASSERT_EQ(ordered_hashmap_size(a->creds_cache), 1u);
+        }
+
+        /* Once the peer disconnects, its entry is dropped again */
+        b = sd_bus_flush_close_unref(b);
+
+        end = usec_add(now(CLOCK_MONOTONIC), 30 * USEC_PER_SEC);
+        while (!ordered_hashmap_isempty(a->creds_cache)) {
+                ASSERT_LT(now(CLOCK_MONOTONIC), end);
+                ASSERT_OK(sd_event_run(event, 100 * USEC_PER_MSEC));
+        }
+}
+
+DEFINE_TEST_MAIN(LOG_DEBUG);
@@ -6,7 +6,9 @@
 #include "log.h"
 #include "macro.h"
 #include "memory-util.h"
+#include "strv.h"
 #include "tests.h"
+#include "time-util.h"
 
 static bool mask[32];
 
@@ -66,6 +68,49 @@ static void test_match_scope(const char *match, enum bus_match_scope scope) {
         assert_se(bus_match_get_scope(components, n_components) == scope);
 }
 
+static int remove_self(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        unsigned *n = ASSERT_PTR(userdata);
+
+        /* Drops the last reference to the floating slot of this match, which removes the match from the
+         * tree as soon as we return, while the tree is still being traversed. */
+        (*n)++;
+        sd_bus_slot_unref(sd_bus_get_current_slot(sd_bus_message_get_bus(m)));
+        return 0;
+}
+
+static void test_match_remove_self(sd_bus *bus, const char *const *namespaces, unsigned n_expected) {
+        unsigned n = 0;
+        usec_t end;
+        int r;
+
+        STRV_FOREACH(i, namespaces) {
+                _cleanup_free_ char *match = NULL;
+
+                ASSERT_NOT_NULL(match = strjoin("type='signal',interface='org.freedesktop.systemd.test',path_namespace='", *i, "'"));
+                ASSERT_OK(sd_bus_add_match(bus, /* ret_slot= */ NULL, match, remove_self, &n));
+        }
+
+        ASSERT_OK(sd_bus_emit_signal(bus, "/org/freedesktop/systemd/test/foo/bar", "org.freedesktop.systemd.test", "Ping", NULL));
+
+        end = usec_add(now(CLOCK_MONOTONIC), 10 * USEC_PER_SEC);
+        while (n < n_expected) {
+                ASSERT_LT(now(CLOCK_MONOTONIC), end);
+
+                r = sd_bus_process(bus, NULL);
+                ASSERT_OK(r);
+                if (r == 0)
+                        ASSERT_OK(sd_bus_wait(bus, 100 * USEC_PER_MSEC));
+        }
+
+        /* Every match ran once, and removed itself */
+        do {
+                r = sd_bus_process(bus, NULL);
+                ASSERT_OK(r);
+        } while (r > 0);
+        ASSERT_EQ(n, n_expected);
+        ASSERT_NULL(bus->match_callbacks.child);
+}
+
 int main(int argc, char *argv[]) {
         struct bus_match_node root = {
                 .type = BUS_MATCH_ROOT,
@@ -73,7 +118,7 @@ int main(int argc, char *argv[]) {
 
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
         _cleanup_(sd_bus_flush_close_unrefp) sd_bus *bus = NULL;
-        sd_bus_slot slots[19] = {};
+        sd_bus_slot slots[23] = {};
         int r;
 
         test_setup_logging(LOG_INFO);
@@ -102,6 +147,10 @@ int main(int argc, char *argv[]) {
         assert_se(match_add(slots, &root, "arg4has='pa'", 16) >= 0);
         assert_se(match_add(slots, &root, "arg4has='po'", 17) >= 0);
         assert_se(match_add(slots, &root, "arg4='pi'", 18) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/'", 19) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/foo/b'", 20) >= 0);
+        assert_se(match_add(slots, &root, "arg3namespace='prefix.four'", 21) >= 0);
+        assert_se(match_add(slots, &root, "arg3namespace='pre'", 22) >= 0);
 
         bus_match_dump(stdout, &root, 0);
 
@@ -111,7 +160,7 @@ int main(int argc, char *argv[]) {
 
         zero(mask);
         assert_se(bus_match_run(NULL, &root, m) == 0);
-        assert_se(mask_contains((unsigned[]) { 9, 8, 7, 5, 10, 12, 13, 14, 15, 16, 17 }, 11));
+        assert_se(mask_contains((unsigned[]) { 9, 8, 7, 5, 10, 12, 13, 14, 15, 16, 17, 19, 21 }, 13));
 
         assert_se(bus_match_remove(&root, &slots[8].match_callback) >= 0);
         assert_se(bus_match_remove(&root, &slots[13].match_callback) >= 0);
@@ -120,7 +169,7 @@ int main(int argc, char *argv[]) {
 
         zero(mask);
         assert_se(bus_match_run(NULL, &root, m) == 0);
-        assert_se(mask_contains((unsigned[]) { 9, 5, 10, 12, 14, 7, 15, 16, 17 }, 9));
+        assert_se(mask_contains((unsigned[]) { 9, 5, 10, 12, 14, 7, 15, 16, 17, 19, 21 }, 11));
 
         for (enum bus_match_node_type i = 0; i < _BUS_MATCH_NODE_TYPE_MAX; i++) {
                 char buf[32];
@@ -134,6 +183,11 @@ int main(int argc, char *argv[]) {
 
         bus_match_free(&root);
 
+        /* A path namespace match removing itself frees the whole path namespace compare node, whose children
+         * are still being looked up. With a second match below it, only its own nodes are released. */
+        test_match_remove_self(bus, STRV_MAKE_CONST("/org/freedesktop/systemd/test/foo"), 1);
+        test_match_remove_self(bus, STRV_MAKE_CONST("/org/freedesktop/systemd/test", "/org/freedesktop/systemd/test/foo"), 2);
+
         test_match_scope("interface='foobar'", BUS_MATCH_GENERIC);
         test_match_scope("", BUS_MATCH_GENERIC);
         test_match_scope("interface='org.freedesktop.DBus.Local'", BUS_MATCH_LOCAL);
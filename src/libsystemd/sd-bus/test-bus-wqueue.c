@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sd-bus.h"
+
+#include "bus-internal.h"
+#include "fd-util.h"
+#include "socket-util.h"
+#include "tests.h"
+
+#define N_MESSAGES 2000U
+
+TEST(wqueue_flush) {
+        _cleanup_(sd_bus_flush_close_unrefp) sd_bus *server = NULL, *client = NULL;
+        _cleanup_close_pair_ int fds[2] = EBADF_PAIR;
+        _cleanup_close_ int payload_fd = -EBADF;
+        unsigned n_received = 0;
+        sd_id128_t id;
+
+        ASSERT_OK_ERRNO(socketpair(AF_UNIX, SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0, fds));
+
+        ASSERT_OK(sd_id128_randomize(&id));
+
+        ASSERT_OK(sd_bus_new(&server));
+        ASSERT_OK(sd_bus_set_fd(server, fds[0], fds[0]));
+        TAKE_FD(fds[0]);
+        ASSERT_OK(sd_bus_set_server(server, true, id));
+        ASSERT_OK(sd_bus_negotiate_fds(server, true));
+        ASSERT_OK(sd_bus_start(server));
+
+        ASSERT_OK(sd_bus_new(&client));
+        ASSERT_OK(sd_bus_set_fd(client, fds[1], fds[1]));
+        TAKE_FD(fds[1]);
+        ASSERT_OK(sd_bus_negotiate_fds(client, true));
+        ASSERT_OK(sd_bus_start(client));
+
+        while (sd_bus_is_ready(client) <= 0 || sd_bus_is_ready(server) <= 0) {
+                ASSERT_OK(sd_bus_process(client, NULL));
+                ASSERT_OK(sd_bus_process(server, NULL));
+        }
+
+        ASSERT_EQ(sd_bus_can_send(client, SD_BUS_TYPE_UNIX_FD), 1);
+
+        /* sd-bus enlarges the socket buffers when starting, hence shrink it only now, so that most messages
+         * end up in the write queue */
+        ASSERT_OK(setsockopt_int(sd_bus_get_fd(client), SOL_SOCKET, SO_SNDBUF, 4096));
+
+        payload_fd = open("/dev/null", O_RDONLY|O_CLOEXEC);
+        ASSERT_OK_ERRNO(payload_fd);
+
+        /* Enqueue a burst of messages, some of which carry a file descriptor, and which thus can't be
+         * written out together with the ones preceding them. */
+        for (unsigned i = 0; i < N_MESSAGES; i++) {
+                _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+
+                ASSERT_OK(sd_bus_message_new_signal(client, &m, "/test", "org.freedesktop.systemd.test", "Test"));
+                ASSERT_OK(sd_bus_message_append(m, "u", i));
+                if (i % 97 == 0)
+                        ASSERT_OK(sd_bus_message_append(m, "h", payload_fd));
+                ASSERT_OK(sd_bus_send(client, m, NULL));
+        }
+
+        ASSERT_GT(client->wqueue_size, 0U);
+
+        while (n_received < N_MESSAGES) {
+                _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+                uint32_t u;
+                int r, k;
+
+                k = sd_bus_process(client, NULL);
+                ASSERT_OK(k);
+                r = sd_bus_process(server, &m);
+                ASSERT_OK(r);
+                if (!m) {
+                        if (r == 0 && k == 0)
+                                ASSERT_OK(sd_bus_wait(server, 100 * USEC_PER_MSEC));
+                        continue;
+                }
+
+                ASSERT_TRUE(sd_bus_message_is_signal(m, "org.freedesktop.systemd.test", "Test"));
+                ASSERT_OK(sd_bus_message_read(m, "u", &u));
+                ASSERT_EQ(u, n_received);
+
+                if (u % 97 == 0) {
+                        int fd;
+
+                        ASSERT_OK(sd_bus_message_read(m, "h", &fd));
+                        ASSERT_OK_ERRNO(fcntl(fd, F_GETFD));
+                } else
+                        ASSERT_OK_POSITIVE(sd_bus_message_at_end(m, true));
+
+                n_received++;
+        }
+
+        ASSERT_EQ(client->wqueue_size, 0U);
+}
+
+DEFINE_TEST_MAIN(LOG_INFO);
@@ -2472,6 +2472,21 @@ _public_ int sd_device_get_sysattr_value(sd_device *device, const char *sysattr,
         if (r != -ENOANO)
                 return r;
 
+        /* Successfully read attributes are cached with their resolved path as key. For plain attribute
+         * names, let's look for that directly, so that we don't need to chase the path again on each
+         * lookup. */
+        if (filename_is_valid(sysattr)) {
+                const char *syspath;
+
+                r = sd_device_get_syspath(device, &syspath);
+                if (r < 0)
+                        return r;
+
+                r = device_get_cached_sysattr_value(device, strjoina(syspath, "/", sysattr), ret_value);
+                if (r != -ENOANO)
+                        return r;
+        }
+
         /* Special cases: read the symlink and return the last component of the value. Some core links return
          * only the last element of the target path, these are just values, the paths should not be exposed. */
         if (STR_IN_SET(sysattr, "driver", "subsystem", "module")) {
@@ -83,14 +83,25 @@ struct sd_event_source {
         unsigned earliest_index;
         unsigned latest_index;
 
+        /* Dispatch statistics, only collected if event loop profiling is enabled, and reset whenever they
+         * are logged. */
+        usec_t pending_usec;
+        unsigned n_dispatched;
+        usec_t dispatch_usec;
+        usec_t dispatch_usec_max;
+        usec_t latency_usec_max;
+
         union {
                 struct {
                         sd_event_io_handler_t callback;
                         int fd;
                         uint32_t events;
                         uint32_t revents;
+                        uint32_t registered_events; /* the events currently registered with epoll */
+                        LIST_FIELDS(sd_event_source, update_list);
                         bool registered:1;
                         bool owned:1;
+                        bool in_update_list:1;
                 } io;
                 struct {
                         sd_event_time_handler_t callback;
@@ -209,6 +220,8 @@ struct inode_data {
         LIST_FIELDS(struct inode_data, to_close);
 };
 
+#define INOTIFY_DATA_BUFFER_SIZE (16U * INOTIFY_EVENT_MAX)
+
 /* A structure encapsulating an inotify fd */
 struct inotify_data {
         WakeupType wakeup;
@@ -222,9 +235,14 @@ struct inotify_data {
         Hashmap *inodes; /* The inode_data structures keyed by dev+ino */
         Hashmap *wd;     /* The inode_data structures keyed by the watch descriptor for each */
 
-        /* The buffer we read inotify events into */
-        union inotify_event_buffer buffer;
-        size_t buffer_filled; /* fill level of the buffer */
+        /* The buffer we read inotify events into. It is large enough to hold a bunch of events, so that a
+         * burst of events on a busy directory doesn't require a separate read() for each one of them. */
+        union {
+                struct inotify_event ev;
+                uint8_t raw[INOTIFY_DATA_BUFFER_SIZE];
+        } buffer;
+        size_t buffer_offset; /* offset of the first event in the buffer not processed yet */
+        size_t buffer_filled; /* fill level of the buffer, counted from buffer_offset */
 
         /* How many event sources are currently marked pending for this inotify. We won't read new events off the
          * inotify fd as long as there are still pending events on the inotify (because we have no strategy of queuing
@@ -35,6 +35,7 @@
 #include "set.h"
 #include "signal-util.h"
 #include "socket-util.h"
+#include "sort-util.h"
 #include "stat-util.h"
 #include "string-table.h"
 #include "string-util.h"
@@ -146,6 +147,9 @@ struct sd_event {
         /* A list of memory pressure event sources that still need their subscription string written */
         LIST_HEAD(sd_event_source, memory_pressure_write_list);
 
+        /* A list of IO event sources whose events mask changed, and still need to be updated in epoll */
+        LIST_HEAD(sd_event_source, io_update_list);
+
         uint64_t origin_id;
 
         uint64_t iteration;
@@ -430,7 +434,8 @@ _public_ int sd_event_new(sd_event** ret) {
         e->epoll_fd = fd_move_above_stdio(e->epoll_fd);
 
         if (secure_getenv("SD_EVENT_PROFILE_DELAYS")) {
-                log_debug("Event loop profiling enabled. Logarithmic histogram of event loop iterations in the range 2^0 %s 2^63 us will be logged every 5s.",
+                log_debug("Event loop profiling enabled. Logarithmic histogram of event loop iterations in the range 2^0 %s 2^63 us, "
+                          "and the event sources that took the most time to dispatch will be logged every 5s.",
                           glyph(GLYPH_ELLIPSIS));
                 e->profile_delays = true;
         }
@@ -482,10 +487,23 @@ _public_ sd_event_source* sd_event_source_disable_unref(sd_event_source *s) {
         return sd_event_source_unref(s);
 }
 
+static void source_io_remove_from_update_list(sd_event_source *s) {
+        assert(s);
+        assert(s->type == SOURCE_IO);
+
+        if (!s->io.in_update_list)
+                return;
+
+        LIST_REMOVE(io.update_list, s->event->io_update_list, s);
+        s->io.in_update_list = false;
+}
+
 static void source_io_unregister(sd_event_source *s) {
         assert(s);
         assert(s->type == SOURCE_IO);
 
+        source_io_remove_from_update_list(s);
+
         if (event_origin_changed(s->event))
                 return;
 
@@ -519,6 +537,8 @@ static int source_io_register(
                 return -errno;
 
         s->io.registered = true;
+        s->io.registered_events = events;
+        source_io_remove_from_update_list(s);
 
         return 0;
 }
@@ -1136,6 +1156,9 @@ static int source_set_pending(sd_event_source *s, bool b) {
         if (b) {
                 s->pending_iteration = s->event->iteration;
 
+                if (s->event->profile_delays)
+                        s->pending_usec = now(CLOCK_MONOTONIC);
+
                 r = prioq_put(s->event->pending, s, &s->pending_index);
                 if (r < 0) {
                         s->pending = false;
@@ -2711,9 +2734,18 @@ _public_ int sd_event_source_set_io_events(sd_event_source *s, uint32_t events)
                 return r;
 
         if (event_source_is_online(s)) {
-                r = source_io_register(s, s->enabled, events);
-                if (r < 0)
-                        return r;
+                /* The source is registered already, hence changing its events mask cannot fail, unless the
+                 * caller closed the fd under our feet. Let's delay updating the registration until we poll
+                 * the next time, so that flipping the mask back and forth, for example whenever a message is
+                 * queued or written, doesn't cost a syscall each time. */
+                assert(s->io.registered);
+
+                if (events == s->io.registered_events && !(events & EPOLLET))
+                        source_io_remove_from_update_list(s);
+                else if (!s->io.in_update_list) {
+                        LIST_PREPEND(io.update_list, s->event->io_update_list, s);
+                        s->io.in_update_list = true;
+                }
         }
 
         s->io.events = events;
@@ -3106,6 +3138,12 @@ _public_ int sd_event_source_set_time(sd_event_source *s, uint64_t usec) {
         assert_return(s->event->state != SD_EVENT_FINISHED, -ESTALE);
         assert_return(!event_origin_changed(s->event), -ECHILD);
 
+        /* Rearming a timer that isn't pending with the time it is already set to changes nothing, hence
+         * don't bother reshuffling the prioqs. This is common for callers that reset the timeout on every
+         * iteration. */
+        if (s->time.next == usec && !s->pending)
+                return 0;
+
         r = source_set_pending(s, false);
         if (r < 0)
                 return r;
@@ -3157,13 +3195,16 @@ _public_ int sd_event_source_set_time_accuracy(sd_event_source *s, uint64_t usec
         assert_return(s->event->state != SD_EVENT_FINISHED, -ESTALE);
         assert_return(!event_origin_changed(s->event), -ECHILD);
 
+        if (usec == 0)
+                usec = DEFAULT_ACCURACY_USEC;
+
+        if (s->time.accuracy == usec && !s->pending)
+                return 0;
+
         r = source_set_pending(s, false);
         if (r < 0)
                 return r;
 
-        if (usec == 0)
-                usec = DEFAULT_ACCURACY_USEC;
-
         s->time.accuracy = usec;
 
         event_source_time_prioq_reshuffle(s);
@@ -3868,7 +3909,7 @@ static int event_inotify_data_read(sd_event *e, struct inotify_data *d, uint32_t
         if (d->priority > threshold)
                 return 0;
 
-        n = read(d->fd, &d->buffer, sizeof(d->buffer));
+        n = read(d->fd, d->buffer.raw, sizeof(d->buffer.raw));
         if (n < 0) {
                 if (ERRNO_IS_TRANSIENT(errno))
                         return 0;
@@ -3877,12 +3918,24 @@ static int event_inotify_data_read(sd_event *e, struct inotify_data *d, uint32_t
         }
 
         assert(n > 0);
+        d->buffer_offset = 0;
         d->buffer_filled = (size_t) n;
         LIST_PREPEND(buffered, e->buffered_inotify_data_list, d);
 
         return 1;
 }
 
+static struct inotify_event* event_inotify_data_current(struct inotify_data *d) {
+        assert(d);
+
+        /* The kernel pads each event's name so that the next event is suitably aligned again, hence we can
+         * simply point into the buffer, there's no need to move the remaining data to the front. */
+        assert(d->buffer_offset % alignof(struct inotify_event) == 0);
+        assert(d->buffer_offset + d->buffer_filled <= sizeof(d->buffer.raw));
+
+        return (struct inotify_event*) (d->buffer.raw + d->buffer_offset);
+}
+
 static void event_inotify_data_drop(sd_event *e, struct inotify_data *d, size_t sz) {
         assert(e);
         assert(d);
@@ -3891,12 +3944,13 @@ static void event_inotify_data_drop(sd_event *e, struct inotify_data *d, size_t
         if (sz == 0)
                 return;
 
-        /* Move the rest to the buffer to the front, in order to get things properly aligned again */
-        memmove(d->buffer.raw, d->buffer.raw + sz, d->buffer_filled - sz);
+        d->buffer_offset += sz;
         d->buffer_filled -= sz;
 
-        if (d->buffer_filled == 0)
+        if (d->buffer_filled == 0) {
+                d->buffer_offset = 0;
                 LIST_REMOVE(buffered, e->buffered_inotify_data_list, d);
+        }
 }
 
 static int event_inotify_data_process(sd_event *e, struct inotify_data *d) {
@@ -3910,22 +3964,27 @@ static int event_inotify_data_process(sd_event *e, struct inotify_data *d) {
                 return 0;
 
         while (d->buffer_filled > 0) {
+                struct inotify_event *ev;
                 size_t sz;
 
                 /* Let's validate that the event structures are complete */
                 if (d->buffer_filled < offsetof(struct inotify_event, name))
                         return -EIO;
 
-                sz = offsetof(struct inotify_event, name) + d->buffer.ev.len;
+                ev = event_inotify_data_current(d);
+                sz = offsetof(struct inotify_event, name) + ev->len;
                 if (d->buffer_filled < sz)
                         return -EIO;
 
-                if (d->buffer.ev.mask & IN_Q_OVERFLOW) {
+                if (ev->mask & IN_Q_OVERFLOW) {
                         struct inode_data *inode_data;
 
                         /* The queue overran, let's pass this event to all event sources connected to this inotify
                          * object */
 
+                        log_debug("Event loop inotify queue of priority %" PRIi64 " overflowed, triggering all watches.",
+                                  d->priority);
+
                         HASHMAP_FOREACH(inode_data, d->inodes)
                                 LIST_FOREACH(inotify.by_inode_data, s, inode_data->event_sources) {
 
@@ -3941,9 +4000,9 @@ static int event_inotify_data_process(sd_event *e, struct inotify_data *d) {
 
                         /* Find the inode object for this watch descriptor. If IN_IGNORED is set we also remove it from
                          * our watch descriptor table. */
-                        if (d->buffer.ev.mask & IN_IGNORED) {
+                        if (ev->mask & IN_IGNORED) {
 
-                                inode_data = hashmap_remove(d->wd, INT_TO_PTR(d->buffer.ev.wd));
+                                inode_data = hashmap_remove(d->wd, INT_TO_PTR(ev->wd));
                                 if (!inode_data) {
                                         event_inotify_data_drop(e, d, sz);
                                         continue;
@@ -3952,7 +4011,7 @@ static int event_inotify_data_process(sd_event *e, struct inotify_data *d) {
                                 /* The watch descriptor was removed by the kernel, let's drop it here too */
                                 inode_data->wd = -1;
                         } else {
-                                inode_data = hashmap_get(d->wd, INT_TO_PTR(d->buffer.ev.wd));
+                                inode_data = hashmap_get(d->wd, INT_TO_PTR(ev->wd));
                                 if (!inode_data) {
                                         event_inotify_data_drop(e, d, sz);
                                         continue;
@@ -3966,8 +4025,8 @@ static int event_inotify_data_process(sd_event *e, struct inotify_data *d) {
                                 if (event_source_is_offline(s))
                                         continue;
 
-                                if ((d->buffer.ev.mask & (IN_IGNORED|IN_UNMOUNT)) == 0 &&
-                                    (s->inotify.mask & d->buffer.ev.mask & IN_ALL_EVENTS) == 0)
+                                if ((ev->mask & (IN_IGNORED|IN_UNMOUNT)) == 0 &&
+                                    (s->inotify.mask & ev->mask & IN_ALL_EVENTS) == 0)
                                         continue;
 
                                 r = source_set_pending(s, true);
@@ -4110,6 +4169,7 @@ static int source_memory_pressure_initiate_dispatch(sd_event_source *s) {
 }
 
 static int source_dispatch(sd_event_source *s) {
+        usec_t dispatch_start = USEC_INFINITY;
         EventSourceType saved_type;
         sd_event *saved_event;
         int r = 0;
@@ -4175,6 +4235,14 @@ static int source_dispatch(sd_event_source *s) {
 
         s->dispatching = true;
 
+        if (saved_event->profile_delays) {
+                dispatch_start = now(CLOCK_MONOTONIC);
+
+                /* Defer and exit sources stay pending, hence the latency is meaningless for them */
+                if (!IN_SET(s->type, SOURCE_DEFER, SOURCE_EXIT) && s->pending_usec != 0)
+                        s->latency_usec_max = MAX(s->latency_usec_max, usec_sub_unsigned(dispatch_start, s->pending_usec));
+        }
+
         switch (s->type) {
 
         case SOURCE_IO:
@@ -4222,13 +4290,15 @@ static int source_dispatch(sd_event_source *s) {
         case SOURCE_INOTIFY: {
                 struct sd_event *e = s->event;
                 struct inotify_data *d;
+                struct inotify_event *ev;
                 size_t sz;
 
                 assert(s->inotify.inode_data);
                 assert_se(d = s->inotify.inode_data->inotify_data);
 
                 assert(d->buffer_filled >= offsetof(struct inotify_event, name));
-                sz = offsetof(struct inotify_event, name) + d->buffer.ev.len;
+                ev = event_inotify_data_current(d);
+                sz = offsetof(struct inotify_event, name) + ev->len;
                 assert(d->buffer_filled >= sz);
 
                 /* If the inotify callback destroys the event source then this likely means we don't need to
@@ -4238,7 +4308,7 @@ static int source_dispatch(sd_event_source *s) {
                  * "busy" with a counter (which will ensure it's not GC'ed away prematurely). Let's then
                  * explicitly GC it after we are done dropping the inotify event from the buffer. */
                 d->n_busy++;
-                r = s->inotify.callback(s, &d->buffer.ev, s->userdata);
+                r = s->inotify.callback(s, ev, s->userdata);
                 d->n_busy--;
 
                 /* When no event is pending anymore on this inotify object, then let's drop the event from
@@ -4263,6 +4333,14 @@ static int source_dispatch(sd_event_source *s) {
 
         s->dispatching = false;
 
+        if (dispatch_start != USEC_INFINITY) {
+                usec_t t = usec_sub_unsigned(now(CLOCK_MONOTONIC), dispatch_start);
+
+                s->n_dispatched++;
+                s->dispatch_usec += t;
+                s->dispatch_usec_max = MAX(s->dispatch_usec_max, t);
+        }
+
 finish:
         if (r < 0) {
                 log_debug_errno(r, "Event source %s (type %s) returned error, %s: %m",
@@ -4438,6 +4516,39 @@ static int event_memory_pressure_write_list(sd_event *e) {
         return 0;
 }
 
+static int event_flush_io_update_list(sd_event *e) {
+        int r;
+
+        assert(e);
+
+        for (;;) {
+                sd_event_source *s;
+
+                s = LIST_POP(io.update_list, e->io_update_list);
+                if (!s)
+                        break;
+
+                assert(s->type == SOURCE_IO);
+                assert(event_source_is_online(s));
+                s->io.in_update_list = false;
+
+                r = source_io_register(s, s->enabled, s->io.events);
+                if (r < 0) {
+                        log_debug_errno(r, "Failed to update events of event source %s (type %s), %s: %m",
+                                        strna(s->description),
+                                        event_source_type_to_string(s->type),
+                                        s->exit_on_failure ? "exiting" : "disabling");
+
+                        if (s->exit_on_failure)
+                                (void) sd_event_exit(e, r);
+
+                        assert_se(sd_event_source_set_enabled(s, SD_EVENT_OFF) >= 0);
+                }
+        }
+
+        return 0;
+}
+
 _public_ int sd_event_prepare(sd_event *e) {
         int r;
 
@@ -4470,6 +4581,10 @@ _public_ int sd_event_prepare(sd_event *e) {
         if (r < 0)
                 return r;
 
+        r = event_flush_io_update_list(e);
+        if (r < 0)
+                return r;
+
         r = event_arm_timer(e, &e->realtime);
         if (r < 0)
                 return r;
@@ -4568,6 +4683,11 @@ static int process_epoll(sd_event *e, usec_t timeout, int64_t threshold, int64_t
         assert(e);
         assert(ret_min_priority);
 
+        /* Event masks might have been changed after sd_event_prepare(), make sure epoll knows about them */
+        r = event_flush_io_update_list(e);
+        if (r < 0)
+                return r;
+
         n_event_queue = MAX(e->n_sources, 1u);
         if (!GREEDY_REALLOC(e->event_queue, n_event_queue))
                 return -ENOMEM;
@@ -4807,6 +4927,51 @@ _public_ int sd_event_dispatch(sd_event *e) {
         return 1;
 }
 
+static int event_source_dispatch_usec_compare(sd_event_source * const *a, sd_event_source * const *b) {
+        /* Sort by time spent dispatching, most first */
+        return CMP((*b)->dispatch_usec, (*a)->dispatch_usec);
+}
+
+#define EVENT_LOG_SOURCES_MAX 10U
+
+static void event_log_sources(sd_event *e) {
+        _cleanup_free_ sd_event_source **sources = NULL;
+        size_t n = 0;
+
+        assert(e);
+
+        /* Logs the event sources that took the most time to dispatch since the last time, and resets their
+         * statistics. */
+
+        sources = new(sd_event_source*, e->n_sources);
+        if (!sources)
+                return (void) log_oom_debug();
+
+        LIST_FOREACH(sources, s, e->sources)
+                if (s->n_dispatched > 0) {
+                        assert(n < e->n_sources);
+                        sources[n++] = s;
+                }
+
+        typesafe_qsort(sources, n, event_source_dispatch_usec_compare);
+
+        FOREACH_ARRAY(i, sources, n) {
+                sd_event_source *s = *i;
+
+                if (i < sources + EVENT_LOG_SOURCES_MAX)
+                        log_debug("Event source %s (type %s): %u dispatches, %s total, %s max, %s max latency",
+                                  strna(s->description),
+                                  event_source_type_to_string(s->type),
+                                  s->n_dispatched,
+                                  FORMAT_TIMESPAN(s->dispatch_usec, 1),
+                                  FORMAT_TIMESPAN(s->dispatch_usec_max, 1),
+                                  FORMAT_TIMESPAN(s->latency_usec_max, 1));
+
+                s->n_dispatched = 0;
+                s->dispatch_usec = s->dispatch_usec_max = s->latency_usec_max = 0;
+        }
+}
+
 static void event_log_delays(sd_event *e) {
         char b[ELEMENTSOF(e->delays) * DECIMAL_STR_MAX(unsigned) + 1], *p;
         size_t l;
@@ -4818,6 +4983,8 @@ static void event_log_delays(sd_event *e) {
                 *delay = 0;
         }
         log_debug("Event loop iterations: %s", b);
+
+        event_log_sources(e);
 }
 
 _public_ int sd_event_run(sd_event *e, uint64_t timeout) {
@@ -724,6 +724,53 @@ TEST(simple_timeout) {
         assert_se(t >= usec_add(f, some_time));
 }
 
+static int rearm_handler(sd_event_source *s, uint64_t usec, void *userdata) {
+        unsigned *c = ASSERT_PTR(userdata);
+
+        (*c)++;
+        return 0;
+}
+
+TEST(time_rearm) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_free_ sd_event_source **sources = NULL;
+        unsigned n_dispatched = 0;
+        usec_t base, start;
+        size_t n = 100000;
+
+        ASSERT_OK(sd_event_new(&e));
+        ASSERT_NOT_NULL(sources = new0(sd_event_source*, n));
+
+        base = now(CLOCK_MONOTONIC) + USEC_PER_HOUR;
+        for (size_t i = 0; i < n; i++)
+                ASSERT_OK(sd_event_add_time(e, &sources[i], CLOCK_MONOTONIC, base + random_u64_range(USEC_PER_HOUR), 0, rearm_handler, &n_dispatched));
+
+        start = now(CLOCK_MONOTONIC);
+        for (size_t i = 0; i < n; i++)
+                ASSERT_OK(sd_event_source_set_time(sources[i], base + random_u64_range(USEC_PER_HOUR)));
+        log_info("Rearming %zu timers took %s", n, FORMAT_TIMESPAN(usec_sub_unsigned(now(CLOCK_MONOTONIC), start), 1));
+
+        start = now(CLOCK_MONOTONIC);
+        for (size_t i = 0; i < n; i++) {
+                usec_t t;
+
+                ASSERT_OK(sd_event_source_get_time(sources[i], &t));
+                ASSERT_OK(sd_event_source_set_time(sources[i], t));
+        }
+        log_info("Rearming %zu timers to the same time took %s", n, FORMAT_TIMESPAN(usec_sub_unsigned(now(CLOCK_MONOTONIC), start), 1));
+
+        /* Move one timer to the past, rearm it to the same time again, and check it is dispatched once */
+        ASSERT_OK(sd_event_source_set_time(sources[0], 1));
+        ASSERT_OK(sd_event_source_set_time(sources[0], 1));
+        ASSERT_OK_POSITIVE(sd_event_run(e, 0));
+        ASSERT_EQ(n_dispatched, 1u);
+        ASSERT_OK_ZERO(sd_event_run(e, 0));
+        ASSERT_EQ(n_dispatched, 1u);
+
+        for (size_t i = 0; i < n; i++)
+                sources[i] = sd_event_source_unref(sources[i]);
+}
+
 static int inotify_self_destroy_handler(sd_event_source *s, const struct inotify_event *ev, void *userdata) {
         sd_event_source **p = userdata;
 
@@ -847,6 +894,67 @@ TEST(sd_event_source_set_io_fd) {
         TAKE_FD(pfd_b[0]);
 }
 
+static int io_events_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        unsigned *c = ASSERT_PTR(userdata);
+
+        ASSERT_EQ(revents, (uint32_t) EPOLLOUT);
+
+        (*c)++;
+        return 0;
+}
+
+TEST(sd_event_source_set_io_events) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *s = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_close_pair_ int pfd[2] = EBADF_PAIR;
+        uint32_t events;
+        unsigned c = 0;
+
+        ASSERT_OK(sd_event_new(&e));
+        ASSERT_OK_ERRNO(pipe2(pfd, O_CLOEXEC));
+
+        /* The write end of a pipe is always writable, but never readable */
+        ASSERT_OK(sd_event_add_io(e, &s, pfd[1], EPOLLIN, io_events_handler, &c));
+        ASSERT_OK_ZERO(sd_event_run(e, 0));
+        ASSERT_EQ(c, 0u);
+
+        /* Flipping the mask back before polling has no effect */
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLOUT));
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLIN));
+        ASSERT_OK(sd_event_source_get_io_events(s, &events));
+        ASSERT_EQ(events, (uint32_t) EPOLLIN);
+        ASSERT_OK_ZERO(sd_event_run(e, 0));
+        ASSERT_EQ(c, 0u);
+
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLOUT));
+        ASSERT_OK(sd_event_source_get_io_events(s, &events));
+        ASSERT_EQ(events, (uint32_t) EPOLLOUT);
+        ASSERT_OK_POSITIVE(sd_event_run(e, 0));
+        ASSERT_EQ(c, 1u);
+
+        /* Changes done between sd_event_prepare() and sd_event_wait() are taken into account too */
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLIN));
+        ASSERT_OK_ZERO(sd_event_prepare(e));
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLOUT));
+        ASSERT_OK_POSITIVE(sd_event_wait(e, 0));
+        ASSERT_OK_POSITIVE(sd_event_dispatch(e));
+        ASSERT_EQ(c, 2u);
+
+        /* Disabling and re-enabling the source applies pending changes right away */
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLIN));
+        ASSERT_OK(sd_event_source_set_enabled(s, SD_EVENT_OFF));
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLOUT));
+        ASSERT_OK(sd_event_source_set_enabled(s, SD_EVENT_ON));
+        ASSERT_OK_POSITIVE(sd_event_run(e, 0));
+        ASSERT_EQ(c, 3u);
+
+        /* Freeing a source with a pending change must not leave it behind in the update list */
+        ASSERT_OK(sd_event_source_set_io_events(s, EPOLLIN));
+        s = sd_event_source_unref(s);
+        ASSERT_OK_ZERO(sd_event_run(e, 0));
+        ASSERT_EQ(c, 3u);
+}
+
 static int hup_callback(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
         unsigned *c = userdata;
 
@@ -25,6 +25,7 @@
 #include "siphash24.h"
 #include "sort-util.h"
 #include "sparse-endian.h"
+#include "stat-util.h"
 #include "strbuf.h"
 #include "string-util.h"
 #include "strv.h"
@@ -602,27 +603,72 @@ static const char* find_id(const void *p, sd_id128_t id) {
                 le64toh(f->offset);
 }
 
-int catalog_get(const char *database, sd_id128_t id, char **ret_text) {
+void catalog_map_done(CatalogMap *m) {
+        assert(m);
+
+        if (m->map)
+                (void) munmap(m->map, m->st.st_size);
+
+        m->map = NULL;
+        m->path = mfree(m->path);
+        m->st = (struct stat) {};
+}
+
+static int catalog_map_refresh(CatalogMap *m, const char *database) {
         int r;
 
+        assert(m);
         assert(database);
-        assert(ret_text);
+
+        /* catalog_update() always writes a new file and renames it into place, hence a quick stat() is
+         * enough to tell whether our mapping is still current. */
+        if (m->map && path_equal(m->path, database)) {
+                struct stat st;
+
+                if (stat(database, &st) < 0)
+                        return -errno;
+
+                if (stat_inode_unmodified(&st, &m->st))
+                        return 0;
+        }
+
+        catalog_map_done(m);
+
+        _cleanup_free_ char *path = strdup(database);
+        if (!path)
+                return -ENOMEM;
 
         _cleanup_close_ int fd = -EBADF;
-        struct stat st;
-        void *p;
-        r = open_mmap(database, &fd, &st, &p);
+        r = open_mmap(database, &fd, &m->st, &m->map);
         if (r < 0)
                 return r;
 
-        const char *s = find_id(p, id);
+        m->path = TAKE_PTR(path);
+        return 0;
+}
+
+int catalog_get_cached(CatalogMap *m, const char *database, sd_id128_t id, char **ret_text) {
+        int r;
+
+        assert(m);
+        assert(database);
+        assert(ret_text);
+
+        r = catalog_map_refresh(m, database);
+        if (r < 0)
+                return r;
+
+        const char *s = find_id(m->map, id);
         if (!s)
-                r = -ENOENT;
-        else
-                r = strdup_to(ret_text, s);
+                return -ENOENT;
 
-        (void) munmap(p, st.st_size);
-        return r;
+        return strdup_to(ret_text, s);
+}
+
+int catalog_get(const char *database, sd_id128_t id, char **ret_text) {
+        _cleanup_(catalog_map_done) CatalogMap m = {};
+
+        return catalog_get_cached(&m, database, id, ret_text);
 }
 
 static char* find_header(const char *s, const char *header) {
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <sys/stat.h>
 
 #include "sd-id128.h"
 
@@ -10,6 +11,17 @@
 
 int catalog_import_file(OrderedHashmap **h, const char *path);
 int catalog_update(const char *database, const char *root, const char* const *dirs);
+
+/* A mapping of the catalog database, kept across lookups, and only reopened if the database got replaced */
+typedef struct CatalogMap {
+        char *path;
+        void *map;
+        struct stat st;
+} CatalogMap;
+
+void catalog_map_done(CatalogMap *m);
+
+int catalog_get_cached(CatalogMap *m, const char *database, sd_id128_t id, char **ret_text);
 int catalog_get(const char *database, sd_id128_t id, char **ret_text);
 int catalog_list(FILE *f, const char *database, bool oneline);
 int catalog_list_items(FILE *f, const char *database, bool oneline, char **items);
@@ -44,6 +44,7 @@
 
 #define DEFAULT_DATA_HASH_TABLE_SIZE (2047ULL*sizeof(HashItem))
 #define DEFAULT_FIELD_HASH_TABLE_SIZE (333ULL*sizeof(HashItem))
+#define MAX_FIELD_HASH_TABLE_SIZE (8ULL*DEFAULT_FIELD_HASH_TABLE_SIZE)
 
 #define DEFAULT_COMPRESS_THRESHOLD (512ULL)
 #define MIN_COMPRESS_THRESHOLD (8ULL)
@@ -79,8 +80,17 @@
 /* How many entries to keep in the entry array chain cache at max */
 #define CHAIN_CACHE_MAX 20
 
-/* How much to increase the journal file size at once each time we allocate something new. */
+/* How many seek results to cache per file */
+#define SEEK_CACHE_MAX 64
+
+/* How much to increase the journal file size at once each time we allocate something new. Files of at
+ * least 4 * FILE_SIZE_INCREASE are grown by a quarter of their current size, up to FILE_SIZE_INCREASE_MAX at
+ * once. */
 #define FILE_SIZE_INCREASE (8 * U64_MB)                  /* 8MB */
+#define FILE_SIZE_INCREASE_MAX (64 * U64_MB)             /* 64MB */
+
+/* Log about allocations that take longer than this */
+#define FILE_ALLOCATE_SLOW_USEC (100 * USEC_PER_MSEC)
 
 /* Reread fstat() of the file for detecting deletions at least this often */
 #define LAST_STAT_REFRESH_USEC (5*USEC_PER_SEC)
@@ -295,6 +305,7 @@ JournalFile* journal_file_close(JournalFile *f) {
         free(f->path);
 
         ordered_hashmap_free(f->chain_cache);
+        ordered_hashmap_free(f->seek_cache);
 
 #if HAVE_COMPRESSION
         free(f->compress_buffer);
@@ -746,7 +757,8 @@ int journal_file_fstat(JournalFile *f) {
 }
 
 static int journal_file_allocate(JournalFile *f, uint64_t offset, uint64_t size) {
-        uint64_t old_size, new_size, old_header_size, old_arena_size;
+        uint64_t old_size, new_size, want_size, increase, old_header_size, old_arena_size, available = UINT64_MAX;
+        usec_t start;
         int r;
 
         assert(f);
@@ -797,8 +809,6 @@ static int journal_file_allocate(JournalFile *f, uint64_t offset, uint64_t size)
                 struct statvfs svfs;
 
                 if (fstatvfs(f->fd, &svfs) >= 0) {
-                        uint64_t available;
-
                         available = LESS_BY(u64_multiply_safe(svfs.f_bfree, svfs.f_bsize), f->metrics.keep_free);
 
                         if (new_size - old_size > available)
@@ -808,16 +818,37 @@ static int journal_file_allocate(JournalFile *f, uint64_t offset, uint64_t size)
 
         /* Increase by larger blocks at once */
         new_size = ROUND_UP(new_size, FILE_SIZE_INCREASE);
+
+        /* Once the file has grown a bit, grow it by a quarter of its size, so that big files are extended
+         * with fewer (and less fragmented) allocations. Small files are kept at the fixed steps above, so
+         * that fresh files don't take more space than before. Only grow beyond what we need right now if
+         * that doesn't eat into the space to keep free. */
+        if (old_size >= 4 * FILE_SIZE_INCREASE) {
+                increase = MIN(old_size / 4, FILE_SIZE_INCREASE_MAX);
+                want_size = ROUND_UP(old_size + increase, FILE_SIZE_INCREASE);
+                if (JOURNAL_HEADER_COMPACT(f->header) && want_size > UINT32_MAX)
+                        want_size = PAGE_ALIGN_DOWN_U64(UINT32_MAX);
+
+                if (want_size > new_size && want_size - old_size <= available)
+                        new_size = want_size;
+        }
+
         if (f->metrics.max_size > 0 && new_size > f->metrics.max_size)
                 new_size = f->metrics.max_size;
 
         /* Note that the glibc fallocate() fallback is very
            inefficient, hence we try to minimize the allocation area
            as we can. */
+        start = now(CLOCK_MONOTONIC);
         r = posix_fallocate_loop(f->fd, old_size, new_size - old_size);
         if (r < 0)
                 return r;
 
+        usec_t t = usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+        if (t >= FILE_ALLOCATE_SLOW_USEC)
+                log_debug("Growing journal file %s by %s took %s.",
+                          f->path, FORMAT_BYTES(new_size - old_size), FORMAT_TIMESPAN(t, USEC_PER_MSEC));
+
         f->header->arena_size = htole64(new_size - old_header_size);
 
         return journal_file_fstat(f);
@@ -1271,7 +1302,7 @@ int journal_file_append_object(
         return 0;
 }
 
-static int journal_file_setup_data_hash_table(JournalFile *f) {
+static int journal_file_setup_data_hash_table(JournalFile *f, JournalFile *template) {
         uint64_t s, p;
         Object *o;
         int r;
@@ -1285,6 +1316,23 @@ static int journal_file_setup_data_hash_table(JournalFile *f) {
            the maximum file size based on these metrics. */
 
         s = (f->metrics.max_size * 4 / 768 / 3) * sizeof(HashItem);
+
+        /* If the file we replace got rotated because its data hash table filled up, the logged data has
+         * a much higher cardinality than the above assumes. In that case, size the table based on the
+         * number of bytes per data object actually seen in that file, so that we don't end up rotating
+         * early again, but never assume less than 192 bytes per object, to bound the space the table
+         * takes up. */
+        if (template && JOURNAL_HEADER_CONTAINS(template->header, n_data)) {
+                uint64_t n_data = le64toh(template->header->n_data),
+                        n_items = le64toh(template->header->data_hash_table_size) / sizeof(HashItem);
+
+                if (n_data * 4ULL > n_items * 3ULL) {
+                        uint64_t per_item = CLAMP(le64toh(template->header->tail_object_offset) / n_data, 192U, 768U);
+
+                        s = MAX(s, (f->metrics.max_size * 4 / per_item / 3) * sizeof(HashItem));
+                }
+        }
+
         if (s < DEFAULT_DATA_HASH_TABLE_SIZE)
                 s = DEFAULT_DATA_HASH_TABLE_SIZE;
 
@@ -1305,7 +1353,7 @@ static int journal_file_setup_data_hash_table(JournalFile *f) {
         return 0;
 }
 
-static int journal_file_setup_field_hash_table(JournalFile *f) {
+static int journal_file_setup_field_hash_table(JournalFile *f, JournalFile *template) {
         uint64_t s, p;
         Object *o;
         int r;
@@ -1314,9 +1362,20 @@ static int journal_file_setup_field_hash_table(JournalFile *f) {
         assert(f->header);
 
         /* We use a fixed size hash table for the fields as this
-         * number should grow very slowly only */
+         * number should grow very slowly only. That is, unless the
+         * file we replace got rotated because its field hash table
+         * filled up, in which case we double its size, up to a limit. */
 
         s = DEFAULT_FIELD_HASH_TABLE_SIZE;
+
+        if (template && JOURNAL_HEADER_CONTAINS(template->header, n_fields)) {
+                uint64_t n_fields = le64toh(template->header->n_fields),
+                        n_items = le64toh(template->header->field_hash_table_size) / sizeof(HashItem);
+
+                if (n_fields * 4ULL > n_items * 3ULL)
+                        s = MAX(s, MIN(n_items * 2 * sizeof(HashItem), MAX_FIELD_HASH_TABLE_SIZE));
+        }
+
         log_debug("Reserving %"PRIu64" entries in field hash table.", s / sizeof(HashItem));
 
         r = journal_file_append_object(f,
@@ -3294,6 +3353,156 @@ use_extra:
         return 1;
 }
 
+typedef struct SeekCacheKey {
+        uint64_t extra;  /* The offset of the 'extra' entry of a data object, or 0 for the main entry array. */
+        uint64_t first;  /* The offset of the first entry array object in the chain. */
+        uint64_t n;      /* The number of items in the chain, the items before are never changed. */
+        uint64_t needle;
+        int (*test_object)(JournalFile *f, uint64_t p, uint64_t needle);
+        direction_t direction;
+} SeekCacheKey;
+
+typedef struct SeekCacheItem {
+        SeekCacheKey key;
+        int result;
+        uint64_t offset;
+} SeekCacheItem;
+
+static void seek_cache_key_hash_func(const SeekCacheKey *k, struct siphash *state) {
+        siphash24_compress_typesafe(k->extra, state);
+        siphash24_compress_typesafe(k->first, state);
+        siphash24_compress_typesafe(k->n, state);
+        siphash24_compress_typesafe(k->needle, state);
+        siphash24_compress_typesafe(k->test_object, state);
+        siphash24_compress_typesafe(k->direction, state);
+}
+
+static int seek_cache_key_compare_func(const SeekCacheKey *x, const SeekCacheKey *y) {
+        int r;
+
+        r = CMP(x->extra, y->extra);
+        if (r != 0)
+                return r;
+
+        r = CMP(x->first, y->first);
+        if (r != 0)
+                return r;
+
+        r = CMP(x->n, y->n);
+        if (r != 0)
+                return r;
+
+        r = CMP(x->needle, y->needle);
+        if (r != 0)
+                return r;
+
+        r = CMP(PTR_TO_UINT64(x->test_object), PTR_TO_UINT64(y->test_object));
+        if (r != 0)
+                return r;
+
+        return CMP(x->direction, y->direction);
+}
+
+DEFINE_PRIVATE_HASH_OPS_WITH_VALUE_DESTRUCTOR(seek_cache_hash_ops,
+                                              SeekCacheKey, seek_cache_key_hash_func, seek_cache_key_compare_func,
+                                              SeekCacheItem, free);
+
+static void seek_cache_put(JournalFile *f, const SeekCacheKey *k, int result, uint64_t offset) {
+        SeekCacheItem *si;
+
+        assert(f);
+        assert(k);
+
+        if (ordered_hashmap_size(f->seek_cache) >= SEEK_CACHE_MAX) {
+                si = ordered_hashmap_steal_first(f->seek_cache);
+                assert(si);
+        } else {
+                si = new(SeekCacheItem, 1);
+                if (!si)
+                        return;
+        }
+
+        *si = (SeekCacheItem) {
+                .key = *k,
+                .result = result,
+                .offset = offset,
+        };
+
+        if (ordered_hashmap_ensure_put(&f->seek_cache, &seek_cache_hash_ops, &si->key, si) < 0)
+                free(si);
+}
+
+static int generic_array_bisect_cached(
+                JournalFile *f,
+                Object *d, /* The data object whose entries to bisect, or NULL for the main entry array. */
+                uint64_t needle,
+                int (*test_object)(JournalFile *f, uint64_t p, uint64_t needle),
+                direction_t direction,
+                Object **ret_object,
+                uint64_t *ret_offset) {
+
+        SeekCacheItem *si;
+        SeekCacheKey k;
+        uint64_t p = 0;
+        int r;
+
+        assert(f);
+        assert(f->header);
+        assert(test_object);
+
+        /* Seeking to the same timestamps or seqnums over and over again is common, e.g. when the same time
+         * window is queried repeatedly. Entry array items are never changed once written, and entries are
+         * only ever appended, hence the result of a bisection only depends on the chain and the number of
+         * items in it, and we can remember it, even for files that are still being written to. */
+
+        if (d) {
+                assert(d->object.type == OBJECT_DATA);
+
+                k = (SeekCacheKey) {
+                        .extra = le64toh(d->data.entry_offset),
+                        .first = le64toh(d->data.entry_array_offset),
+                        .n = le64toh(d->data.n_entries),
+                };
+        } else
+                k = (SeekCacheKey) {
+                        .first = le64toh(f->header->entry_array_offset),
+                        .n = le64toh(f->header->n_entries),
+                };
+
+        k.needle = needle;
+        k.test_object = test_object;
+        k.direction = direction;
+
+        si = ordered_hashmap_get(f->seek_cache, &k);
+        if (si) {
+                r = si->result;
+                p = si->offset;
+        } else {
+                if (d)
+                        r = generic_array_bisect_for_data(f, d, needle, test_object, direction, NULL, &p);
+                else
+                        r = generic_array_bisect(f, k.first, k.n, needle, test_object, direction, NULL, &p, NULL);
+                if (r < 0)
+                        return r;
+
+                seek_cache_put(f, &k, r, p);
+        }
+
+        if (r == 0)
+                return 0;
+
+        if (ret_object) {
+                r = journal_file_move_to_object(f, OBJECT_ENTRY, p, ret_object);
+                if (r < 0)
+                        return r;
+        }
+
+        if (ret_offset)
+                *ret_offset = p;
+
+        return 1;
+}
+
 static int test_object_offset(JournalFile *f, uint64_t p, uint64_t needle) {
         assert(f);
         assert(p > 0);
@@ -3357,14 +3566,13 @@ int journal_file_move_to_entry_by_seqnum(
         assert(f);
         assert(f->header);
 
-        return generic_array_bisect(
+        return generic_array_bisect_cached(
                         f,
-                        le64toh(f->header->entry_array_offset),
-                        le64toh(f->header->n_entries),
+                        /* d= */ NULL,
                         seqnum,
                         test_object_seqnum,
                         direction,
-                        ret_object, ret_offset, NULL);
+                        ret_object, ret_offset);
 }
 
 static int test_object_realtime(JournalFile *f, uint64_t p, uint64_t needle) {
@@ -3388,6 +3596,36 @@ static int test_object_realtime(JournalFile *f, uint64_t p, uint64_t needle) {
                 return TEST_RIGHT;
 }
 
+static int realtime_compare_to_file(JournalFile *f, uint64_t realtime) {
+        uint64_t head, tail;
+
+        assert(f);
+        assert(f->header);
+
+        /* Returns < 0 if the specified timestamp is before the first entry of the file, > 0 if it is after
+         * the last entry, and 0 otherwise, or if we can't tell without looking at the entries. Bisection
+         * assumes the entries to be ordered by their realtime timestamp anyway, hence when seeking to a
+         * timestamp outside of the range covered by the file we can use its first or last entry right
+         * away, without touching any entry arrays. This matters when seeking in many archived files, most
+         * of which cover a different time range than the one we are interested in.
+         *
+         * The head timestamp is never changed once set, but the tail timestamp is only meaningful if
+         * nobody else is appending to the file, i.e. if it is archived or we are the writer. */
+
+        head = le64toh(READ_NOW(f->header->head_entry_realtime));
+        if (head > 0 && realtime < head)
+                return -1;
+
+        if (f->header->state != STATE_ARCHIVED && !journal_file_writable(f))
+                return 0;
+
+        tail = le64toh(READ_NOW(f->header->tail_entry_realtime));
+        if (tail > 0 && realtime > tail)
+                return 1;
+
+        return 0;
+}
+
 int journal_file_move_to_entry_by_realtime(
                 JournalFile *f,
                 uint64_t realtime,
@@ -3395,17 +3633,27 @@ int journal_file_move_to_entry_by_realtime(
                 Object **ret_object,
                 uint64_t *ret_offset) {
 
+        int c;
+
         assert(f);
         assert(f->header);
 
-        return generic_array_bisect(
+        c = realtime_compare_to_file(f, realtime);
+        if (c != 0) {
+                if ((c < 0) == (direction == DIRECTION_UP))
+                        return 0;
+
+                /* p == 0 means the first (or last on DIRECTION_UP) entry */
+                return journal_file_next_entry(f, 0, direction, ret_object, ret_offset);
+        }
+
+        return generic_array_bisect_cached(
                         f,
-                        le64toh(f->header->entry_array_offset),
-                        le64toh(f->header->n_entries),
+                        /* d= */ NULL,
                         realtime,
                         test_object_realtime,
                         direction,
-                        ret_object, ret_offset, NULL);
+                        ret_object, ret_offset);
 }
 
 static int test_object_monotonic(JournalFile *f, uint64_t p, uint64_t needle) {
@@ -3460,7 +3708,7 @@ int journal_file_move_to_entry_by_monotonic(
         if (r <= 0)
                 return r;
 
-        return generic_array_bisect_for_data(
+        return generic_array_bisect_cached(
                         f,
                         o,
                         monotonic,
@@ -3693,12 +3941,12 @@ int journal_file_move_to_entry_by_monotonic_for_data(
         if (r <= 0)
                 return r;
 
-        r = generic_array_bisect_for_data(f,
-                                          o,
-                                          monotonic,
-                                          test_object_monotonic,
-                                          direction,
-                                          NULL, &z);
+        r = generic_array_bisect_cached(f,
+                                        o,
+                                        monotonic,
+                                        test_object_monotonic,
+                                        direction,
+                                        NULL, &z);
         if (r <= 0)
                 return r;
 
@@ -3749,7 +3997,7 @@ int journal_file_move_to_entry_by_seqnum_for_data(
         assert(d);
         assert(d->object.type == OBJECT_DATA);
 
-        return generic_array_bisect_for_data(
+        return generic_array_bisect_cached(
                         f,
                         d,
                         seqnum,
@@ -3765,11 +4013,21 @@ int journal_file_move_to_entry_by_realtime_for_data(
                 direction_t direction,
                 Object **ret, uint64_t *ret_offset) {
 
+        int c;
+
         assert(f);
         assert(d);
         assert(d->object.type == OBJECT_DATA);
 
-        return generic_array_bisect_for_data(
+        c = realtime_compare_to_file(f, realtime);
+        if (c != 0) {
+                if ((c < 0) == (direction == DIRECTION_UP))
+                        return 0;
+
+                return journal_file_move_to_entry_for_data(f, d, direction, ret, ret_offset);
+        }
+
+        return generic_array_bisect_cached(
                         f,
                         d,
                         realtime,
@@ -4222,11 +4480,11 @@ int journal_file_open(
 #endif
 
         if (newly_created) {
-                r = journal_file_setup_field_hash_table(f);
+                r = journal_file_setup_field_hash_table(f, template);
                 if (r < 0)
                         goto fail;
 
-                r = journal_file_setup_data_hash_table(f);
+                r = journal_file_setup_data_hash_table(f, template);
                 if (r < 0)
                         goto fail;
 
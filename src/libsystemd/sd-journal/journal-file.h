@@ -95,6 +95,7 @@ typedef struct JournalFile {
         usec_t post_change_timer_period;
 
         OrderedHashmap *chain_cache;
+        OrderedHashmap *seek_cache;
 
         pthread_t offline_thread;
         volatile OfflineState offline_state;
@@ -8,6 +8,7 @@
 #include "sd-id128.h"
 #include "sd-journal.h"
 
+#include "catalog.h"
 #include "hashmap.h"
 #include "journal-def.h"
 #include "journal-file.h"
@@ -37,6 +38,7 @@ struct Match {
         char *data;
         size_t size;
         uint64_t hash; /* old-style jenkins hash. New-style siphash is different per file, hence won't be cached here */
+        Hashmap *data_cache; /* JournalFile* → MatchDataCache, see find_data_object_for_match() */
 
         /* For terms */
         LIST_HEAD(Match, matches);
@@ -69,6 +71,12 @@ struct Directory {
         unsigned last_seen_generation;
 };
 
+typedef struct MergeItem {
+        sd_journal *journal;
+        JournalFile *file;
+        unsigned prioq_idx;
+} MergeItem;
+
 typedef struct NewestByBootId {
         sd_id128_t boot_id;
         Prioq *prioq; /* JournalFile objects ordered by monotonic timestamp of last update. */
@@ -94,6 +102,19 @@ struct sd_journal {
         JournalFile *current_file;
         uint64_t current_field;
 
+        /* Merge state for iterating in one direction: all files with a candidate entry are queued in
+         * 'merge_prioq' ordered by their candidate's location. Files that reached EOF but might still grow
+         * are kept in 'merge_watch' and rechecked on each step, all others are not looked at anymore. */
+        MergeItem *merge_items;
+        size_t n_merge_items;
+        Prioq *merge_prioq;
+        MergeItem **merge_watch;
+        size_t n_merge_watch;
+        MergeItem *merge_current;
+        direction_t merge_direction;
+        unsigned merge_invalidate_counter;
+        bool merge_valid;
+
         Match *level0, *level1, *level2;
         Set *exclude_syslog_identifiers;
 
@@ -108,6 +129,7 @@ struct sd_journal {
         char *unique_field;
         JournalFile *unique_file;
         uint64_t unique_offset;
+        Set *unique_hashes; /* Fingerprints of values returned so far, see sd_journal_enumerate_unique() */
 
         /* Iterating through known fields */
         JournalFile *fields_file;
@@ -115,6 +137,9 @@ struct sd_journal {
         uint64_t fields_hash_table_index;
         char *fields_buffer;
 
+        /* The catalog database, mapped on first use of sd_journal_get_catalog() */
+        CatalogMap catalog_map;
+
         int flags;
 
         bool on_network:1;
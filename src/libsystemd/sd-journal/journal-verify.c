@@ -12,12 +12,14 @@
 #include "fileio.h"
 #include "fs-util.h"
 #include "gcrypt-util.h"
+#include "hash-funcs.h"
 #include "journal-authenticate.h"
 #include "journal-def.h"
 #include "journal-file.h"
 #include "journal-verify.h"
 #include "lookup3.h"
 #include "macro.h"
+#include "sort-util.h"
 #include "terminal-util.h"
 #include "tmpfile-util.h"
 
@@ -391,52 +393,52 @@ static int write_uint64(FILE *fp, uint64_t p) {
         return 0;
 }
 
-static int contains_uint64(MMapFileDescriptor *f, uint64_t n, uint64_t p) {
-        uint64_t a, b;
-        int r;
-
-        assert(f);
-
-        /* Bisection ... */
+static bool contains_uint64(const uint64_t *array, uint64_t n, uint64_t p) {
+        /* The offsets were recorded in the order we found the objects in the file, hence are sorted */
+        return typesafe_bsearch(&p, array, n, uint64_compare_func);
+}
 
-        a = 0; b = n;
-        while (a < b) {
-                uint64_t c, *z;
+static int map_offsets(FILE *fp, uint64_t n, const uint64_t **ret) {
+        void *a;
 
-                c = (a + b) / 2;
+        assert(fp);
+        assert(ret);
 
-                r = mmap_cache_fd_get(f, 0, false, c * sizeof(uint64_t), sizeof(uint64_t), NULL, (void **) &z);
-                if (r < 0)
-                        return r;
+        /* Maps the list of offsets we wrote to the temporary file in one go, so that we can look them up
+         * with a plain bisection, instead of going through the mmap cache for each bisection step. */
 
-                if (*z == p)
-                        return 1;
+        if (n == 0) {
+                *ret = NULL;
+                return 0;
+        }
 
-                if (a + 1 >= b)
-                        return 0;
+        if (n > SIZE_MAX / sizeof(uint64_t))
+                return -EFBIG;
 
-                if (p < *z)
-                        b = c;
-                else
-                        a = c;
-        }
+        a = mmap(NULL, n * sizeof(uint64_t), PROT_READ, MAP_SHARED, fileno(fp), 0);
+        if (a == MAP_FAILED)
+                return -errno;
 
+        *ret = a;
         return 0;
 }
 
+static void unmap_offsets(const uint64_t *array, uint64_t n) {
+        if (array)
+                (void) munmap((void*) array, n * sizeof(uint64_t));
+}
+
 static int verify_data(
                 JournalFile *f,
                 Object *o, uint64_t p,
-                MMapFileDescriptor *cache_entry_fd, uint64_t n_entries,
-                MMapFileDescriptor *cache_entry_array_fd, uint64_t n_entry_arrays) {
+                const uint64_t *entry_offsets, uint64_t n_entries,
+                const uint64_t *entry_array_offsets, uint64_t n_entry_arrays) {
 
         uint64_t i, n, a, last, q;
         int r;
 
         assert(f);
         assert(o);
-        assert(cache_entry_fd);
-        assert(cache_entry_array_fd);
 
         n = le64toh(o->data.n_entries);
         a = le64toh(o->data.entry_array_offset);
@@ -454,18 +456,15 @@ static int verify_data(
         assert(o->data.entry_offset);
 
         last = q = le64toh(o->data.entry_offset);
-        if (!contains_uint64(cache_entry_fd, n_entries, q)) {
+        if (!contains_uint64(entry_offsets, n_entries, q)) {
                 error(p, "Data object references invalid entry at "OFSfmt, q);
                 return -EBADMSG;
         }
 
-        r = journal_file_move_to_entry_by_offset(f, q, DIRECTION_DOWN, NULL, NULL);
-        if (r < 0)
-                return r;
-        if (r == 0) {
-                error(q, "Entry object doesn't exist in the main entry array");
-                return -EBADMSG;
-        }
+        /* Note that we don't need to look up the entry in the main entry array here:
+         * verify_entry_array() already checked that the main entry array is strictly sorted, has as many
+         * items as there are entry objects, and only references entry objects, hence it contains every
+         * entry object that we found while iterating through the file. */
 
         i = 1;
         while (i < n) {
@@ -476,7 +475,7 @@ static int verify_data(
                         return -EBADMSG;
                 }
 
-                if (!contains_uint64(cache_entry_array_fd, n_entry_arrays, a)) {
+                if (!contains_uint64(entry_array_offsets, n_entry_arrays, a)) {
                         error(p, "Invalid array offset "OFSfmt, a);
                         return -EBADMSG;
                 }
@@ -501,23 +500,10 @@ static int verify_data(
                         }
                         last = q;
 
-                        if (!contains_uint64(cache_entry_fd, n_entries, q)) {
+                        if (!contains_uint64(entry_offsets, n_entries, q)) {
                                 error(p, "Data object references invalid entry at "OFSfmt, q);
                                 return -EBADMSG;
                         }
-
-                        r = journal_file_move_to_entry_by_offset(f, q, DIRECTION_DOWN, NULL, NULL);
-                        if (r < 0)
-                                return r;
-                        if (r == 0) {
-                                error(q, "Entry object doesn't exist in the main entry array");
-                                return -EBADMSG;
-                        }
-
-                        /* Pointer might have moved, reposition */
-                        r = journal_file_move_to_object(f, OBJECT_ENTRY_ARRAY, a, &o);
-                        if (r < 0)
-                                return r;
                 }
 
                 a = next;
@@ -528,9 +514,9 @@ static int verify_data(
 
 static int verify_data_hash_table(
                 JournalFile *f,
-                MMapFileDescriptor *cache_data_fd, uint64_t n_data,
-                MMapFileDescriptor *cache_entry_fd, uint64_t n_entries,
-                MMapFileDescriptor *cache_entry_array_fd, uint64_t n_entry_arrays,
+                const uint64_t *data_offsets, uint64_t n_data,
+                const uint64_t *entry_offsets, uint64_t n_entries,
+                const uint64_t *entry_array_offsets, uint64_t n_entry_arrays,
                 usec_t *last_usec,
                 bool show_progress) {
 
@@ -538,9 +524,6 @@ static int verify_data_hash_table(
         int r;
 
         assert(f);
-        assert(cache_data_fd);
-        assert(cache_entry_fd);
-        assert(cache_entry_array_fd);
         assert(last_usec);
 
         n = le64toh(f->header->data_hash_table_size) / sizeof(HashItem);
@@ -562,7 +545,7 @@ static int verify_data_hash_table(
                         Object *o;
                         uint64_t next;
 
-                        if (!contains_uint64(cache_data_fd, n_data, p)) {
+                        if (!contains_uint64(data_offsets, n_data, p)) {
                                 error(p, "Invalid data object at hash entry %"PRIu64" of %"PRIu64, i, n);
                                 return -EBADMSG;
                         }
@@ -582,7 +565,7 @@ static int verify_data_hash_table(
                                 return -EBADMSG;
                         }
 
-                        r = verify_data(f, o, p, cache_entry_fd, n_entries, cache_entry_array_fd, n_entry_arrays);
+                        r = verify_data(f, o, p, entry_offsets, n_entries, entry_array_offsets, n_entry_arrays);
                         if (r < 0)
                                 return r;
 
@@ -637,7 +620,7 @@ static int data_object_in_hash_table(JournalFile *f, uint64_t hash, uint64_t p)
 static int verify_entry(
                 JournalFile *f,
                 Object *o, uint64_t p,
-                MMapFileDescriptor *cache_data_fd, uint64_t n_data,
+                const uint64_t *data_offsets, uint64_t n_data,
                 bool last) {
 
         uint64_t i, n;
@@ -645,7 +628,6 @@ static int verify_entry(
 
         assert(f);
         assert(o);
-        assert(cache_data_fd);
 
         n = journal_file_entry_n_items(f, o);
         for (i = 0; i < n; i++) {
@@ -654,7 +636,7 @@ static int verify_entry(
 
                 q = journal_file_entry_item_object_offset(f, o, i);
 
-                if (!contains_uint64(cache_data_fd, n_data, q)) {
+                if (!contains_uint64(data_offsets, n_data, q)) {
                         error(p, "Invalid data object of entry");
                         return -EBADMSG;
                 }
@@ -694,9 +676,9 @@ static int verify_entry(
 
 static int verify_entry_array(
                 JournalFile *f,
-                MMapFileDescriptor *cache_data_fd, uint64_t n_data,
-                MMapFileDescriptor *cache_entry_fd, uint64_t n_entries,
-                MMapFileDescriptor *cache_entry_array_fd, uint64_t n_entry_arrays,
+                const uint64_t *data_offsets, uint64_t n_data,
+                const uint64_t *entry_offsets, uint64_t n_entries,
+                const uint64_t *entry_array_offsets, uint64_t n_entry_arrays,
                 usec_t *last_usec,
                 bool show_progress) {
 
@@ -704,9 +686,6 @@ static int verify_entry_array(
         int r;
 
         assert(f);
-        assert(cache_data_fd);
-        assert(cache_entry_fd);
-        assert(cache_entry_array_fd);
         assert(last_usec);
 
         n = le64toh(f->header->n_entries);
@@ -723,7 +702,7 @@ static int verify_entry_array(
                         return -EBADMSG;
                 }
 
-                if (!contains_uint64(cache_entry_array_fd, n_entry_arrays, a)) {
+                if (!contains_uint64(entry_array_offsets, n_entry_arrays, a)) {
                         error(a, "Invalid array %"PRIu64" of %"PRIu64, i, n);
                         return -EBADMSG;
                 }
@@ -749,7 +728,7 @@ static int verify_entry_array(
                         }
                         last = p;
 
-                        if (!contains_uint64(cache_entry_fd, n_entries, p)) {
+                        if (!contains_uint64(entry_offsets, n_entries, p)) {
                                 error(a, "Invalid array entry at %"PRIu64" of %"PRIu64, i, n);
                                 return -EBADMSG;
                         }
@@ -758,7 +737,7 @@ static int verify_entry_array(
                         if (r < 0)
                                 return r;
 
-                        r = verify_entry(f, o, p, cache_data_fd, n_data, /*last=*/ i + 1 == n);
+                        r = verify_entry(f, o, p, data_offsets, n_data, /*last=*/ i + 1 == n);
                         if (r < 0)
                                 return r;
 
@@ -828,11 +807,10 @@ int journal_file_verify(
         usec_t last_usec = 0;
         _cleanup_close_ int data_fd = -EBADF, entry_fd = -EBADF, entry_array_fd = -EBADF;
         _cleanup_fclose_ FILE *data_fp = NULL, *entry_fp = NULL, *entry_array_fp = NULL;
-        MMapFileDescriptor *cache_data_fd = NULL, *cache_entry_fd = NULL, *cache_entry_array_fd = NULL;
+        const uint64_t *data_offsets = NULL, *entry_offsets = NULL, *entry_array_offsets = NULL;
         unsigned i;
         bool found_last = false;
         const char *tmp_dir = NULL;
-        MMapCache *m;
 
 #if HAVE_GCRYPT
         uint64_t last_tag = 0;
@@ -877,25 +855,6 @@ int journal_file_verify(
                 goto fail;
         }
 
-        m = mmap_cache_fd_cache(f->cache_fd);
-        r = mmap_cache_add_fd(m, data_fd, PROT_READ|PROT_WRITE, &cache_data_fd);
-        if (r < 0) {
-                log_error_errno(r, "Failed to cache data file: %m");
-                goto fail;
-        }
-
-        r = mmap_cache_add_fd(m, entry_fd, PROT_READ|PROT_WRITE, &cache_entry_fd);
-        if (r < 0) {
-                log_error_errno(r, "Failed to cache entry file: %m");
-                goto fail;
-        }
-
-        r = mmap_cache_add_fd(m, entry_array_fd, PROT_READ|PROT_WRITE, &cache_entry_array_fd);
-        if (r < 0) {
-                log_error_errno(r, "Failed to cache entry array file: %m");
-                goto fail;
-        }
-
         r = take_fdopen_unlocked(&data_fd, "w+", &data_fp);
         if (r < 0) {
                 log_error_errno(r, "Failed to open data file stream: %m");
@@ -1371,6 +1330,24 @@ int journal_file_verify(
                 goto fail;
         }
 
+        r = map_offsets(data_fp, n_data, &data_offsets);
+        if (r < 0) {
+                log_error_errno(r, "Failed to map data file: %m");
+                goto fail;
+        }
+
+        r = map_offsets(entry_fp, n_entries, &entry_offsets);
+        if (r < 0) {
+                log_error_errno(r, "Failed to map entry file: %m");
+                goto fail;
+        }
+
+        r = map_offsets(entry_array_fp, n_entry_arrays, &entry_array_offsets);
+        if (r < 0) {
+                log_error_errno(r, "Failed to map entry array file: %m");
+                goto fail;
+        }
+
         /* Second iteration: we follow all objects referenced from the
          * two entry points: the object hash table and the entry
          * array. We also check that everything referenced (directly
@@ -1380,18 +1357,18 @@ int journal_file_verify(
          * referenced is consistent. */
 
         r = verify_entry_array(f,
-                               cache_data_fd, n_data,
-                               cache_entry_fd, n_entries,
-                               cache_entry_array_fd, n_entry_arrays,
+                               data_offsets, n_data,
+                               entry_offsets, n_entries,
+                               entry_array_offsets, n_entry_arrays,
                                &last_usec,
                                show_progress);
         if (r < 0)
                 goto fail;
 
         r = verify_data_hash_table(f,
-                                   cache_data_fd, n_data,
-                                   cache_entry_fd, n_entries,
-                                   cache_entry_array_fd, n_entry_arrays,
+                                   data_offsets, n_data,
+                                   entry_offsets, n_entries,
+                                   entry_array_offsets, n_entry_arrays,
                                    &last_usec,
                                    show_progress);
         if (r < 0)
@@ -1400,9 +1377,9 @@ int journal_file_verify(
         if (show_progress)
                 flush_progress();
 
-        mmap_cache_fd_free(cache_data_fd);
-        mmap_cache_fd_free(cache_entry_fd);
-        mmap_cache_fd_free(cache_entry_array_fd);
+        unmap_offsets(data_offsets, n_data);
+        unmap_offsets(entry_offsets, n_entries);
+        unmap_offsets(entry_array_offsets, n_entry_arrays);
 
         if (first_contained)
                 *first_contained = le64toh(f->header->head_entry_realtime);
@@ -1425,14 +1402,9 @@ fail:
                   (uint64_t) f->last_stat.st_size,
                   100U * p / (uint64_t) f->last_stat.st_size);
 
-        if (cache_data_fd)
-                mmap_cache_fd_free(cache_data_fd);
-
-        if (cache_entry_fd)
-                mmap_cache_fd_free(cache_entry_fd);
-
-        if (cache_entry_array_fd)
-                mmap_cache_fd_free(cache_entry_array_fd);
+        unmap_offsets(data_offsets, n_data);
+        unmap_offsets(entry_offsets, n_entries);
+        unmap_offsets(entry_array_offsets, n_entry_arrays);
 
         return r;
 }
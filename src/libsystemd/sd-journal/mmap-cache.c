@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 
@@ -50,6 +51,10 @@ struct MMapFileDescriptor {
         int prot;
         bool sigbus;
 
+        /* Location of the most recently created window, for detecting sequential access */
+        uint64_t last_offset;
+        size_t last_size;
+
         LIST_HEAD(Window, windows);
 };
 
@@ -60,6 +65,7 @@ struct MMapCache {
         unsigned n_category_cache_hit;
         unsigned n_window_list_hit;
         unsigned n_missed;
+        unsigned n_readahead;
 
         Hashmap *fds;
 
@@ -278,6 +284,36 @@ static int mmap_try_harder(MMapFileDescriptor *f, void *addr, int flags, uint64_
         }
 }
 
+static void readahead_if_sequential(MMapFileDescriptor *f, uint64_t offset, size_t size) {
+        MMapCache *m = mmap_cache_fd_cache(f);
+        uint64_t ra, len;
+
+        assert(f);
+
+        /* If the new window continues the previously created one, the file is most likely read
+         * sequentially, in one direction or the other. In that case, ask the kernel to asynchronously read
+         * the next window's worth of data in that direction, so that we don't stall on page faults once we
+         * get there, which is particularly painful on rotating disks and network file systems. We only do
+         * this for read-only maps, pages we are going to write to are better not read from disk at all. */
+
+        if (f->prot != PROT_READ || f->last_size == 0)
+                return;
+
+        if (offset > f->last_offset && offset <= f->last_offset + f->last_size) {
+                /* forward */
+                ra = offset + size;
+                len = size;
+        } else if (offset < f->last_offset && offset + size >= f->last_offset) {
+                /* backward */
+                ra = LESS_BY(offset, (uint64_t) size);
+                len = offset - ra;
+        } else
+                return;
+
+        if (len > 0 && posix_fadvise(f->fd, ra, len, POSIX_FADV_WILLNEED) == 0)
+                m->n_readahead++;
+}
+
 static int add_mmap(
                 MMapFileDescriptor *f,
                 uint64_t offset,
@@ -332,6 +368,10 @@ static int add_mmap(
                 return -ENOMEM;
         }
 
+        readahead_if_sequential(f, offset, size);
+        f->last_offset = offset;
+        f->last_size = size;
+
         *ret = w;
         return 0;
 }
@@ -436,8 +476,8 @@ found:
 void mmap_cache_stats_log_debug(MMapCache *m) {
         assert(m);
 
-        log_debug("mmap cache statistics: %u category cache hit, %u window list hit, %u miss, %u files, %u windows, %u unused",
-                  m->n_category_cache_hit, m->n_window_list_hit, m->n_missed, hashmap_size(m->fds), m->n_windows, m->n_unused);
+        log_debug("mmap cache statistics: %u category cache hit, %u window list hit, %u miss, %u readahead, %u files, %u windows, %u unused",
+                  m->n_category_cache_hit, m->n_window_list_hit, m->n_missed, m->n_readahead, hashmap_size(m->fds), m->n_windows, m->n_unused);
 }
 
 static void mmap_cache_process_sigbus(MMapCache *m) {
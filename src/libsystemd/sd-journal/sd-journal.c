@@ -93,6 +93,13 @@ static int journal_put_error(sd_journal *j, int r, const char *path) {
         return 0;
 }
 
+static void merge_invalidate(sd_journal *j) {
+        assert(j);
+
+        j->merge_valid = false;
+        j->merge_current = NULL;
+}
+
 static void detach_location(sd_journal *j) {
         JournalFile *f;
 
@@ -100,6 +107,7 @@ static void detach_location(sd_journal *j) {
 
         j->current_file = NULL;
         j->current_field = 0;
+        merge_invalidate(j);
 
         ORDERED_HASHMAP_FOREACH(f, j->files)
                 journal_file_reset_location(f);
@@ -211,10 +219,23 @@ static Match *match_free(Match *m) {
         if (m->parent)
                 LIST_REMOVE(matches, m->parent->matches, m);
 
+        hashmap_free(m->data_cache);
         free(m->data);
         return mfree(m);
 }
 
+static void match_forget_file(Match *m, JournalFile *f) {
+        assert(f);
+
+        if (!m)
+                return;
+
+        free(hashmap_remove(m->data_cache, f));
+
+        LIST_FOREACH(matches, i, m->matches)
+                match_forget_file(i, f);
+}
+
 static Match *match_free_if_empty(Match *m) {
         if (!m || m->matches)
                 return m;
@@ -665,6 +686,82 @@ static int compare_with_location(
         return 0;
 }
 
+typedef struct MatchDataCache {
+        uint64_t offset;        /* Offset of the data object, or 0 if the file does not contain it */
+        uint64_t n_data;        /* Number of data objects in the file at the time of a negative lookup */
+} MatchDataCache;
+
+static int find_data_object_for_match(JournalFile *f, Match *m, Object **ret_object, uint64_t *ret_offset) {
+        _cleanup_free_ MatchDataCache *n = NULL;
+        MatchDataCache *c;
+        uint64_t hash, p = 0;
+        int r;
+
+        assert(f);
+        assert(f->header);
+        assert(m);
+        assert(m->type == MATCH_DISCRETE);
+        assert(ret_object);
+
+        /* Looking up a data object in the hash table of a file is comparatively expensive, and it is done
+         * again for every step through the file, for every file. Hence, let's cache the result per file:
+         * data objects never move once written, so a positive result stays valid. A negative result stays
+         * valid as long as no data objects are added, which is always the case for archived files. This
+         * makes sparse matches on files that do not contain the data at all almost free. */
+
+        c = hashmap_get(m->data_cache, f);
+        if (c) {
+                if (c->offset > 0) {
+                        r = journal_file_move_to_object(f, OBJECT_DATA, c->offset, ret_object);
+                        if (r < 0)
+                                return r;
+
+                        if (ret_offset)
+                                *ret_offset = c->offset;
+                        return 1;
+                }
+
+                if (c->n_data == le64toh(READ_NOW(f->header->n_data)))
+                        return 0;
+        }
+
+        /* If the keyed hash logic is used, we need to calculate the hash fresh per file. Otherwise we can
+         * use what we pre-calculated. */
+        if (JOURNAL_HEADER_KEYED_HASH(f->header))
+                hash = journal_file_hash_data(f, m->data, m->size);
+        else
+                hash = m->hash;
+
+        r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, ret_object, &p);
+        if (r < 0)
+                return r;
+
+        /* Without the n_data field in the header we cannot tell whether a negative result is stale. */
+        if (r > 0 || JOURNAL_HEADER_CONTAINS(f->header, n_data)) {
+                if (!c) {
+                        n = new(MatchDataCache, 1);
+                        if (!n)
+                                return -ENOMEM;
+
+                        if (hashmap_ensure_put(&m->data_cache, &trivial_hash_ops_value_free, f, n) < 0)
+                                n = mfree(n); /* Not fatal, we just won't cache the result */
+                        else
+                                c = TAKE_PTR(n);
+                }
+
+                if (c)
+                        *c = (MatchDataCache) {
+                                .offset = r > 0 ? p : 0,
+                                .n_data = r > 0 ? 0 : le64toh(READ_NOW(f->header->n_data)),
+                        };
+        }
+
+        if (r > 0 && ret_offset)
+                *ret_offset = p;
+
+        return r;
+}
+
 static int next_for_match(
                 sd_journal *j,
                 Match *m,
@@ -683,16 +780,8 @@ static int next_for_match(
 
         if (m->type == MATCH_DISCRETE) {
                 Object *d;
-                uint64_t hash;
 
-                /* If the keyed hash logic is used, we need to calculate the hash fresh per file. Otherwise
-                 * we can use what we pre-calculated. */
-                if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        hash = journal_file_hash_data(f, m->data, m->size);
-                else
-                        hash = m->hash;
-
-                r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, &d, NULL);
+                r = find_data_object_for_match(f, m, &d, NULL);
                 if (r <= 0)
                         return r;
 
@@ -828,14 +917,9 @@ static int find_location_for_match(
 
         if (m->type == MATCH_DISCRETE) {
                 Object *d;
-                uint64_t dp, hash;
-
-                if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        hash = journal_file_hash_data(f, m->data, m->size);
-                else
-                        hash = m->hash;
+                uint64_t dp;
 
-                r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, &d, &dp);
+                r = find_data_object_for_match(f, m, &d, &dp);
                 if (r <= 0)
                         return r;
 
@@ -1123,15 +1207,43 @@ static int compare_locations(sd_journal *j, JournalFile *af, JournalFile *bf) {
         return CMP(af->current_xor_hash, bf->current_xor_hash);
 }
 
-static int real_journal_next(sd_journal *j, direction_t direction) {
-        JournalFile *new_file = NULL;
+static int merge_item_compare(const MergeItem *a, const MergeItem *b) {
+        int r;
+
+        assert(a);
+        assert(b);
+        assert(a->journal == b->journal);
+
+        r = compare_locations(a->journal, a->file, b->file);
+        return a->journal->merge_direction == DIRECTION_DOWN ? r : -r;
+}
+
+static bool merge_file_needs_recheck(sd_journal *j, JournalFile *f) {
+        assert(j);
+        assert(f);
+
+        /* Returns true if a file without a candidate entry might have one on a later step: either because
+         * new entries might be appended to it, or because it was not positioned yet as the location we
+         * seeked to was not discrete, see next_beyond_location(). */
+
+        if (f->last_direction != j->merge_direction)
+                return true;
+
+        return !FLAGS_SET(j->flags, SD_JOURNAL_ASSUME_IMMUTABLE) &&
+                f->header->state != STATE_ARCHIVED;
+}
+
+static int merge_build(sd_journal *j, direction_t direction) {
         unsigned n_files;
         const void **files;
-        Object *o;
         int r;
 
-        assert_return(j, -EINVAL);
-        assert_return(!journal_origin_changed(j), -ECHILD);
+        assert(j);
+
+        /* Positions all files for the next step in the given direction, by looking at every single one of
+         * them, and queues all files that have a candidate entry. */
+
+        merge_invalidate(j);
 
         r = iterated_cache_get(j->files_cache, NULL, &files, &n_files);
         if (r < 0)
@@ -1139,39 +1251,187 @@ static int real_journal_next(sd_journal *j, direction_t direction) {
 
         FOREACH_ARRAY(_f, files, n_files) {
                 JournalFile *f = (JournalFile*) *_f;
-                bool found;
 
                 r = next_beyond_location(j, f, direction);
                 if (r < 0) {
                         log_debug_errno(r, "Can't iterate through %s, ignoring: %m", f->path);
                         remove_file_real(j, f);
-                        continue;
-                } else if (r == 0) {
+                } else if (r == 0)
                         f->location_type = direction == DIRECTION_DOWN ? LOCATION_TAIL : LOCATION_HEAD;
+        }
+
+        /* Files might have been removed above, hence query the list again. */
+        r = iterated_cache_get(j->files_cache, NULL, &files, &n_files);
+        if (r < 0)
+                return r;
+
+        j->merge_prioq = prioq_free(j->merge_prioq);
+        j->n_merge_items = j->n_merge_watch = 0;
+
+        if (!GREEDY_REALLOC(j->merge_items, n_files) ||
+            !GREEDY_REALLOC(j->merge_watch, n_files))
+                return -ENOMEM;
+
+        j->merge_prioq = prioq_new((compare_func_t) merge_item_compare);
+        if (!j->merge_prioq)
+                return -ENOMEM;
+
+        j->merge_direction = direction;
+
+        FOREACH_ARRAY(_f, files, n_files) {
+                JournalFile *f = (JournalFile*) *_f;
+                MergeItem *i = j->merge_items + j->n_merge_items++;
+
+                *i = (MergeItem) {
+                        .journal = j,
+                        .file = f,
+                        .prioq_idx = PRIOQ_IDX_NULL,
+                };
+
+                if (f->location_type == LOCATION_SEEK) {
+                        r = prioq_put(j->merge_prioq, i, &i->prioq_idx);
+                        if (r < 0)
+                                return r;
+                } else if (merge_file_needs_recheck(j, f))
+                        j->merge_watch[j->n_merge_watch++] = i;
+        }
+
+        j->merge_invalidate_counter = j->current_invalidate_counter;
+        j->merge_valid = true;
+
+        return 0;
+}
+
+static int merge_advance(sd_journal *j, MergeItem *i) {
+        int r;
+
+        assert(j);
+        assert(i);
+
+        /* Moves the file beyond the current location, and requeues it. Returns 0 if the merge state needs
+         * to be rebuilt, 1 otherwise. */
+
+        r = next_beyond_location(j, i->file, j->merge_direction);
+        if (r < 0) {
+                log_debug_errno(r, "Can't iterate through %s, ignoring: %m", i->file->path);
+                remove_file_real(j, i->file);
+                merge_invalidate(j);
+                return 0;
+        }
+        if (r == 0) {
+                i->file->location_type = j->merge_direction == DIRECTION_DOWN ? LOCATION_TAIL : LOCATION_HEAD;
+
+                if (i->prioq_idx != PRIOQ_IDX_NULL)
+                        assert_se(prioq_remove(j->merge_prioq, i, &i->prioq_idx) > 0);
+
+                if (merge_file_needs_recheck(j, i->file))
+                        j->merge_watch[j->n_merge_watch++] = i;
+
+                return 1;
+        }
+
+        if (i->prioq_idx == PRIOQ_IDX_NULL) {
+                r = prioq_put(j->merge_prioq, i, &i->prioq_idx);
+                if (r < 0)
+                        return r;
+        } else
+                prioq_reshuffle(j->merge_prioq, i, &i->prioq_idx);
+
+        return 1;
+}
+
+static int merge_next(sd_journal *j) {
+        MergeItem **watch;
+        size_t n_watch;
+        int r;
+
+        assert(j);
+        assert(j->merge_valid);
+
+        /* Instead of looking at every file on every step, only advance the file whose entry we picked last
+         * time, recheck the files that hit EOF but might have grown since, and then make sure the file with
+         * the earliest candidate is not looking at a duplicate of the current entry. All other files still
+         * point to valid candidates beyond the current location. Returns 0 if the merge state needs to be
+         * rebuilt, 1 otherwise. */
+
+        if (j->merge_current) {
+                r = merge_advance(j, TAKE_PTR(j->merge_current));
+                if (r <= 0)
+                        return r;
+        }
+
+        /* merge_advance() might append to the watch list, hence take it over first. */
+        watch = j->merge_watch;
+        n_watch = j->n_merge_watch;
+        j->n_merge_watch = 0;
+
+        for (size_t k = 0; k < n_watch; k++) {
+                MergeItem *i = watch[k];
+
+                if (i->prioq_idx != PRIOQ_IDX_NULL)
                         continue;
-                }
 
-                if (!new_file)
-                        found = true;
-                else {
-                        r = compare_locations(j, f, new_file);
-                        found = direction == DIRECTION_DOWN ? r < 0 : r > 0;
-                }
+                r = merge_advance(j, i);
+                if (r <= 0)
+                        return r;
+        }
 
-                if (found)
-                        new_file = f;
+        for (;;) {
+                MergeItem *i;
+                uint64_t p;
+
+                i = prioq_peek(j->merge_prioq);
+                if (!i)
+                        return 1;
+
+                p = i->file->current_offset;
+
+                r = merge_advance(j, i);
+                if (r <= 0)
+                        return r;
+
+                if (i->file->location_type == LOCATION_SEEK && i->file->current_offset == p)
+                        return 1;
+        }
+}
+
+static int real_journal_next(sd_journal *j, direction_t direction) {
+        MergeItem *i;
+        Object *o;
+        int r;
+
+        assert_return(j, -EINVAL);
+        assert_return(!journal_origin_changed(j), -ECHILD);
+
+        r = 0;
+        if (j->merge_valid &&
+            j->merge_direction == direction &&
+            j->merge_invalidate_counter == j->current_invalidate_counter)
+                r = merge_next(j);
+        if (r < 0)
+                goto fail;
+        if (r == 0) {
+                r = merge_build(j, direction);
+                if (r < 0)
+                        goto fail;
         }
 
-        if (!new_file)
+        i = prioq_peek(j->merge_prioq);
+        if (!i)
                 return 0;
 
-        r = journal_file_move_to_object(new_file, OBJECT_ENTRY, new_file->current_offset, &o);
+        r = journal_file_move_to_object(i->file, OBJECT_ENTRY, i->file->current_offset, &o);
         if (r < 0)
-                return r;
+                goto fail;
 
-        set_location(j, new_file, o);
+        set_location(j, i->file, o);
+        j->merge_current = i;
 
         return 1;
+
+fail:
+        merge_invalidate(j);
+        return r;
 }
 
 _public_ int sd_journal_next(sd_journal *j) {
@@ -1797,6 +2057,7 @@ static void remove_file_real(sd_journal *j, JournalFile *f) {
                         j->fields_file_lost = true;
         }
 
+        match_forget_file(j->level0, f);
         journal_file_unlink_newest_by_boot_id(j, f);
         (void) journal_file_close(f);
 
@@ -2548,6 +2809,10 @@ _public_ void sd_journal_close(sd_journal *j) {
         if (j->mmap)
                 mmap_cache_stats_log_debug(j->mmap);
 
+        prioq_free(j->merge_prioq);
+        free(j->merge_items);
+        free(j->merge_watch);
+
         ordered_hashmap_free(j->files);
         iterated_cache_free(j->files_cache);
 
@@ -2570,7 +2835,9 @@ _public_ void sd_journal_close(sd_journal *j) {
         free(j->prefix);
         free(j->namespace);
         free(j->unique_field);
+        set_free(j->unique_hashes);
         free(j->fields_buffer);
+        catalog_map_done(&j->catalog_map);
         free(j);
 }
 
@@ -3338,6 +3605,7 @@ _public_ int sd_journal_query_unique(sd_journal *j, const char *field) {
         j->unique_file = NULL;
         j->unique_offset = 0;
         j->unique_file_lost = false;
+        set_clear(j->unique_hashes);
 
         return 0;
 }
@@ -3371,6 +3639,7 @@ _public_ int sd_journal_enumerate_unique(
                 Object *o;
                 void *odata;
                 size_t ol;
+                uint64_t h;
                 bool found;
                 int r;
 
@@ -3426,6 +3695,24 @@ _public_ int sd_journal_enumerate_unique(
                                                j->unique_offset,
                                                j->unique_field);
 
+                /* Before looking into the earlier traversed files, check the fingerprints of the values we
+                 * returned so far. If the fingerprint is not known we definitely did not return this value
+                 * yet, and can skip the per-file lookups, which are expensive if many files are open.
+                 * Fingerprint collisions only mean we take the slow path below, hence a plain unkeyed hash
+                 * is good enough here. Note that on 32-bit archs the fingerprint is truncated, which only
+                 * makes collisions more likely. */
+                h = jenkins_hash64(odata, ol);
+                if (!set_contains(j->unique_hashes, UINT64_TO_PTR(h))) {
+                        r = set_ensure_put(&j->unique_hashes, NULL, UINT64_TO_PTR(h));
+                        if (r < 0)
+                                return r;
+
+                        *ret_data = odata;
+                        *ret_size = ol;
+
+                        return 1;
+                }
+
                 /* OK, now let's see if we already returned this data object by checking if it exists in the
                  * earlier traversed files. */
                 found = false;
@@ -3483,6 +3770,7 @@ _public_ void sd_journal_restart_unique(sd_journal *j) {
         j->unique_file = NULL;
         j->unique_offset = 0;
         j->unique_file_lost = false;
+        set_clear(j->unique_hashes);
 }
 
 _public_ int sd_journal_enumerate_fields(sd_journal *j, const char **field) {
@@ -3686,7 +3974,7 @@ _public_ int sd_journal_get_catalog(sd_journal *j, char **ret) {
         if (r < 0)
                 return r;
 
-        r = catalog_get(secure_getenv("SYSTEMD_CATALOG") ?: CATALOG_DATABASE, id, &text);
+        r = catalog_get_cached(&j->catalog_map, secure_getenv("SYSTEMD_CATALOG") ?: CATALOG_DATABASE, id, &text);
         if (r < 0)
                 return r;
 
@@ -0,0 +1,255 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sd-id128.h"
+#include "sd-journal.h"
+#include "sd-json.h"
+
+#include "alloc-util.h"
+#include "chattr-util.h"
+#include "compress.h"
+#include "fd-util.h"
+#include "fileio.h"
+#include "iovec-util.h"
+#include "journal-file-util.h"
+#include "journal-internal.h"
+#include "parse-util.h"
+#include "path-util.h"
+#include "process-util.h"
+#include "rm-rf.h"
+#include "tests.h"
+#include "time-util.h"
+#include "tmpfile-util.h"
+
+/* Writes a journal file whose field cardinalities resemble those of a real system, and then times a
+ * couple of typical journalctl queries against it, once for each supported compression algorithm.
+ * Results are printed as one JSON object per algorithm, so that they can be compared between runs.
+ *
+ * Usage: test-journal-benchmark [N_ENTRIES] */
+
+#define N_UNITS 60U
+#define N_CODE_LOCATIONS 400U
+#define N_TAIL 100U
+
+static unsigned arg_n_entries = 100000;
+
+typedef struct Query {
+        const char *name;
+        const char *matches[5];
+        const char *unique_field;
+        bool tail;
+} Query;
+
+static const Query queries[] = {
+        { "all"                                                                                  },
+        { "unit",          { "_SYSTEMD_UNIT=unit1.service" }                                     },
+        { "rare-unit",     { "_SYSTEMD_UNIT=unit59.service" }                                    },
+        { "unit-priority", { "_SYSTEMD_UNIT=unit0.service", "PRIORITY=3" }                       },
+        { "priority",      { "PRIORITY=0", "PRIORITY=1", "PRIORITY=2", "PRIORITY=3" }            },
+        { "tail",          .tail = true                                                          },
+        { "unique-units",  .unique_field = "_SYSTEMD_UNIT"                                       },
+};
+
+static unsigned pick_priority(uint64_t *state) {
+        unsigned p = test_random_u64(state) % 100;
+
+        return p < 70 ? 6 : p < 85 ? 7 : p < 95 ? 5 : p < 98 ? 4 : p % 4;
+}
+
+static usec_t append_entries(JournalFile *f) {
+        static const char *const templates[] = {
+                "Accepted connection from client",
+                "Request served successfully after",
+                "Failed to resolve host, retrying in",
+                "Started session for user with id",
+                "Reloading configuration, generation",
+        };
+        const sd_id128_t boot_id = SD_ID128_MAKE(5f,1e,8b,2f,46,c4,4d,7b,a0,3e,c2,e9,41,d4,65,a8);
+        dual_timestamp ts = {
+                .realtime = 1700000000 * USEC_PER_SEC,
+                .monotonic = USEC_PER_SEC,
+        };
+        uint64_t state = 0x2545f4914f6cdd1d; /* Fixed seed, so that every run writes the same entries */
+        usec_t start;
+
+        start = now(CLOCK_MONOTONIC);
+
+        for (unsigned i = 0; i < arg_n_entries; i++) {
+                char message[LINE_MAX], priority[64], identifier[64], unit[64], pid[64],
+                        uid[64], gid[64], comm[64], exe[64], code_file[64], code_line[64];
+                unsigned u = test_random_skewed(&state, N_UNITS), l = test_random_skewed(&state, N_CODE_LOCATIONS);
+                uint64_t delta = test_random_u64(&state) % 1000 + 1;
+
+                xsprintf(message, "MESSAGE=%s %" PRIu64 " (%u)",
+                         templates[l % ELEMENTSOF(templates)], test_random_u64(&state) % 100000, i);
+                xsprintf(priority, "PRIORITY=%u", pick_priority(&state));
+                xsprintf(identifier, "SYSLOG_IDENTIFIER=unit%u", u);
+                xsprintf(unit, "_SYSTEMD_UNIT=unit%u.service", u);
+                xsprintf(pid, "_PID=%u", 1000 + u * 8 + (unsigned) (test_random_u64(&state) % 8));
+                xsprintf(uid, "_UID=%u", u < 10 ? 0 : 1000 + u);
+                xsprintf(gid, "_GID=%u", u < 10 ? 0 : 1000 + u);
+                xsprintf(comm, "_COMM=unit%u", u);
+                xsprintf(exe, "_EXE=/usr/bin/unit%u", u);
+                xsprintf(code_file, "CODE_FILE=src/unit%u/file%u.c", u, l % 16);
+                xsprintf(code_line, "CODE_LINE=%u", l * 7);
+
+                struct iovec iovec[] = {
+                        IOVEC_MAKE_STRING(message),
+                        IOVEC_MAKE_STRING(priority),
+                        IOVEC_MAKE_STRING(identifier),
+                        IOVEC_MAKE_STRING(unit),
+                        IOVEC_MAKE_STRING(pid),
+                        IOVEC_MAKE_STRING(uid),
+                        IOVEC_MAKE_STRING(gid),
+                        IOVEC_MAKE_STRING(comm),
+                        IOVEC_MAKE_STRING(exe),
+                        IOVEC_MAKE_STRING(code_file),
+                        IOVEC_MAKE_STRING(code_line),
+                        IOVEC_MAKE_STRING(u % 3 == 0 ? "_TRANSPORT=stdout" : "_TRANSPORT=journal"),
+                        IOVEC_MAKE_STRING("_BOOT_ID=5f1e8b2f46c44d7ba03ec2e941d465a8"),
+                        IOVEC_MAKE_STRING("_HOSTNAME=benchmark"),
+                };
+
+                ts.realtime += delta;
+                ts.monotonic += delta;
+
+                ASSERT_OK(journal_file_append_entry(f, &ts, &boot_id, iovec, ELEMENTSOF(iovec), NULL, NULL, NULL, NULL));
+        }
+
+        return usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+}
+
+static void drop_page_cache(const char *path) {
+        _cleanup_close_ int fd = -EBADF;
+
+        /* The file was synced when it was closed, hence all its pages are clean and can be dropped */
+        fd = open(path, O_RDONLY|O_CLOEXEC);
+        ASSERT_OK_ERRNO(fd);
+        ASSERT_EQ(posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED), 0);
+}
+
+static usec_t run_query(const char *path, const Query *q, bool cold, uint64_t *ret_n) {
+        _cleanup_(sd_journal_closep) sd_journal *j = NULL;
+        uint64_t n = 0;
+        usec_t start;
+        int r;
+
+        if (cold)
+                drop_page_cache(path);
+
+        start = now(CLOCK_MONOTONIC);
+
+        ASSERT_OK(sd_journal_open_files(&j, (const char*[]) { path, NULL }, SD_JOURNAL_ASSUME_IMMUTABLE));
+
+        if (q->unique_field) {
+                const void *d;
+                size_t l;
+
+                ASSERT_OK(sd_journal_query_unique(j, q->unique_field));
+                SD_JOURNAL_FOREACH_UNIQUE(j, d, l)
+                        n++;
+
+                *ret_n = n;
+                return usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+        }
+
+        for (const char *const *m = q->matches; *m; m++)
+                ASSERT_OK(sd_journal_add_match(j, *m, SIZE_MAX));
+
+        if (q->tail)
+                ASSERT_OK(sd_journal_seek_tail(j));
+
+        while (!q->tail || n < N_TAIL) {
+                const void *d;
+                size_t l;
+
+                r = q->tail ? sd_journal_previous(j) : sd_journal_next(j);
+                ASSERT_OK(r);
+                if (r == 0)
+                        break;
+
+                ASSERT_OK(sd_journal_get_data(j, "MESSAGE", &d, &l));
+                n++;
+        }
+
+        *ret_n = n;
+        return usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+}
+
+static void run_benchmark(Compression c) {
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *v = NULL, *results = NULL;
+        _cleanup_(rm_rf_physical_and_freep) char *t = NULL;
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        _cleanup_free_ char *path = NULL;
+        JournalFile *f;
+        struct stat st;
+        usec_t append_usec;
+
+        /* The compression algorithm is picked up once per thread, hence this is called in a child */
+        ASSERT_OK_ERRNO(setenv("SYSTEMD_JOURNAL_COMPRESS", compression_to_string(c), /* overwrite = */ true));
+
+        ASSERT_OK(mkdtemp_malloc("/var/tmp/journal-benchmark-XXXXXX", &t));
+        (void) chattr_path(t, FS_NOCOW_FL, FS_NOCOW_FL);
+
+        ASSERT_NOT_NULL(path = path_join(t, "benchmark.journal"));
+        ASSERT_NOT_NULL(m = mmap_cache_new());
+
+        ASSERT_OK(journal_file_open(-EBADF, path, O_RDWR|O_CREAT, JOURNAL_COMPRESS, 0644, UINT64_MAX, NULL, m, NULL, &f));
+        append_usec = append_entries(f);
+        (void) journal_file_offline_close(f);
+
+        ASSERT_OK_ERRNO(stat(path, &st));
+
+        FOREACH_ELEMENT(q, queries) {
+                uint64_t n_cold, n_warm;
+                usec_t cold, warm;
+
+                cold = run_query(path, q, /* cold = */ true, &n_cold);
+                warm = run_query(path, q, /* cold = */ false, &n_warm);
+                ASSERT_EQ(n_cold, n_warm);
+
+                ASSERT_OK(sd_json_variant_set_fieldbo(
+                                &results, q->name,
+                                SD_JSON_BUILD_PAIR_UNSIGNED("results", n_cold),
+                                SD_JSON_BUILD_PAIR_UNSIGNED("coldUSec", cold),
+                                SD_JSON_BUILD_PAIR_UNSIGNED("warmUSec", warm)));
+        }
+
+        ASSERT_OK(sd_json_buildo(
+                        &v,
+                        SD_JSON_BUILD_PAIR_STRING("compression", compression_lowercase_to_string(c)),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("entries", arg_n_entries),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("appendUSec", append_usec),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("entriesPerSecond", (uint64_t) arg_n_entries * USEC_PER_SEC / MAX(append_usec, 1u)),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("fileSize", st.st_size),
+                        SD_JSON_BUILD_PAIR_VARIANT("queries", results)));
+
+        ASSERT_OK(sd_json_variant_dump(v, SD_JSON_FORMAT_NEWLINE, stdout, NULL));
+        ASSERT_OK(fflush_and_check(stdout));
+}
+
+int main(int argc, char *argv[]) {
+        int r;
+
+        test_setup_logging(LOG_INFO);
+
+        if (argc >= 2)
+                ASSERT_OK(safe_atou(argv[1], &arg_n_entries));
+
+        for (Compression c = 0; c < _COMPRESSION_MAX; c++) {
+                if (!compression_supported(c))
+                        continue;
+
+                r = safe_fork("(journal-benchmark)", FORK_WAIT|FORK_LOG|FORK_DEATHSIG_SIGTERM, NULL);
+                ASSERT_OK(r);
+                if (r == 0) {
+                        run_benchmark(c);
+                        _exit(EXIT_SUCCESS);
+                }
+        }
+
+        return 0;
+}
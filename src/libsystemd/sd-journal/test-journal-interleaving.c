@@ -430,6 +430,78 @@ TEST(skip) {
         test_skip_one(setup_interleaved);
 }
 
+TEST(merge) {
+        _cleanup_(test_donep) char *t = NULL;
+        _cleanup_(sd_journal_closep) sd_journal *j = NULL;
+        JournalFile *f[8], *live;
+        sd_id128_t id;
+
+        mkdtemp_chdir_chattr("/var/tmp/journal-merge-XXXXXX", &t);
+
+        /* Spread the entries over a couple of archived files, and one file that is kept online, so that
+         * only the latter needs to be rechecked for new entries while iterating. */
+
+        ASSERT_OK(sd_id128_randomize(&id));
+
+        FOREACH_ELEMENT(i, f) {
+                _cleanup_free_ char *fn = NULL;
+
+                ASSERT_OK(asprintf(&fn, "archived%zu.journal", (size_t) (i - f)));
+                *i = test_open(fn);
+        }
+        live = test_open("live.journal");
+
+        for (unsigned n = 1; n <= 24; n++)
+                append_number(n % 3 == 0 ? live : f[n % ELEMENTSOF(f)], n, &id, NULL, NULL);
+
+        FOREACH_ELEMENT(i, f) {
+                (*i)->archive = true;
+                *i = journal_file_offline_close(*i);
+        }
+
+        journal_file_post_change(live);
+
+        ASSERT_OK(sd_journal_open_directory(&j, t, 0));
+
+        ASSERT_OK(sd_journal_seek_head(j));
+        ASSERT_OK_POSITIVE(sd_journal_next(j));
+        test_check_numbers_down(j, 24);
+        test_check_numbers_up(j, 24);
+
+        /* Change direction in the middle */
+        ASSERT_OK(sd_journal_seek_head(j));
+        ASSERT_OK_POSITIVE(sd_journal_next_skip(j, 12));
+        test_check_number(j, 12);
+        ASSERT_OK_POSITIVE(sd_journal_previous(j));
+        test_check_number(j, 11);
+        ASSERT_OK_POSITIVE(sd_journal_next(j));
+        test_check_number(j, 12);
+
+        /* Entries appended to the online file after we hit EOF must show up. */
+        ASSERT_OK(sd_journal_seek_tail(j));
+        ASSERT_OK_POSITIVE(sd_journal_previous(j));
+        test_check_number(j, 24);
+        ASSERT_OK_ZERO(sd_journal_next(j));
+
+        append_number(live, 25, &id, NULL, NULL);
+        append_number(live, 26, &id, NULL, NULL);
+        journal_file_post_change(live);
+
+        ASSERT_OK_POSITIVE(sd_journal_next(j));
+        test_check_number(j, 25);
+        ASSERT_OK_POSITIVE(sd_journal_next(j));
+        test_check_number(j, 26);
+        ASSERT_OK_ZERO(sd_journal_next(j));
+
+        /* And the same with a match, which needs to be honoured for the rechecked file too */
+        ASSERT_OK(sd_journal_add_match(j, "LESS_THAN_FIVE=yes", SIZE_MAX));
+        ASSERT_OK(sd_journal_seek_head(j));
+        ASSERT_OK_POSITIVE(sd_journal_next(j));
+        test_check_numbers_down(j, 4);
+
+        (void) journal_file_offline_close(live);
+}
+
 static void test_boot_id_one(void (*setup)(void), size_t n_ids_expected) {
         _cleanup_(test_donep) char *t = NULL;
         _cleanup_(sd_journal_closep) sd_journal *j = NULL;
@@ -854,6 +926,9 @@ static void test_generic_array_bisect_one(size_t n, size_t num_corrupted) {
         /* Reset chain cache. */
         ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_offset(f, offset[0], DIRECTION_DOWN, NULL, NULL));
 
+        /* Also forget the cached seek results, as we modify the entries behind the file's back below. */
+        f->seek_cache = ordered_hashmap_free(f->seek_cache);
+
         /* make journal corrupted by clearing seqnum. */
         for (size_t i = n - num_corrupted; i < n; i++) {
                 Object *o;
@@ -174,6 +174,194 @@ TEST(empty) {
         test_empty_one();
 }
 
+TEST(hash_table_size_from_template) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        JournalMetrics metrics = { .max_size = 2 * U64_MB, .min_size = UINT64_MAX, .max_use = UINT64_MAX, .min_use = UINT64_MAX, .keep_free = UINT64_MAX, .n_max_files = UINT64_MAX };
+        JournalFile *f, *f2, *f3;
+        dual_timestamp ts;
+        char t[] = "/var/tmp/journal-XXXXXX";
+        uint64_t n_items;
+
+        ASSERT_NOT_NULL(m = mmap_cache_new());
+
+        mkdtemp_chdir_chattr(t);
+
+        ASSERT_OK(journal_file_open(-EBADF, "test.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, &metrics, m, NULL, &f));
+        n_items = le64toh(f->header->data_hash_table_size) / sizeof(HashItem);
+
+        /* A successor of a file whose hash table is not filled up gets the same table size */
+        ASSERT_OK(journal_file_open(-EBADF, "test2.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, f, &f2));
+        ASSERT_EQ(le64toh(f2->header->data_hash_table_size), le64toh(f->header->data_hash_table_size));
+        ASSERT_EQ(le64toh(f2->header->field_hash_table_size), le64toh(f->header->field_hash_table_size));
+        (void) journal_file_offline_close(f2);
+
+        /* Fill the data hash table with distinct small data objects until rotation is suggested */
+        assert_se(dual_timestamp_now(&ts));
+        for (unsigned i = 0; !journal_file_rotate_suggested(f, 0, LOG_DEBUG); i++) {
+                _cleanup_free_ char *d = NULL;
+
+                ASSERT_OK(asprintf(&d, "N=%u", i));
+                ASSERT_OK(journal_file_append_entry(f, &ts, NULL, &IOVEC_MAKE_STRING(d), 1, NULL, NULL, NULL, NULL));
+                ASSERT_LE(i, n_items);
+        }
+
+        ASSERT_OK(journal_file_open(-EBADF, "test3.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, f, &f3));
+        ASSERT_GT(le64toh(f3->header->data_hash_table_size), le64toh(f->header->data_hash_table_size));
+        ASSERT_EQ(le64toh(f3->header->field_hash_table_size), le64toh(f->header->field_hash_table_size));
+        (void) journal_file_offline_close(f3);
+
+        (void) journal_file_offline_close(f);
+
+        if (arg_keep)
+                log_info("Not removing %s", t);
+        else
+                ASSERT_OK(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL));
+}
+
+TEST(seek_cache) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        static const char test[] = "TEST1=1";
+        JournalFile *f;
+        dual_timestamp ts;
+        char t[] = "/var/tmp/journal-XXXXXX";
+        Object *o, *d;
+        uint64_t p, q;
+
+        ASSERT_NOT_NULL(m = mmap_cache_new());
+
+        mkdtemp_chdir_chattr(t);
+
+        ASSERT_OK(journal_file_open(-EBADF, "test.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, NULL, &f));
+
+        for (uint64_t i = 1; i <= 100; i++) {
+                ts = (dual_timestamp) { .realtime = i * 10, .monotonic = i * 10 };
+                ASSERT_OK(journal_file_append_entry(f, &ts, NULL, &IOVEC_MAKE_STRING(test), 1, NULL, NULL, NULL, NULL));
+        }
+
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime(f, 505, DIRECTION_DOWN, &o, &p));
+        ASSERT_EQ(le64toh(o->entry.realtime), 510u);
+        ASSERT_EQ(ordered_hashmap_size(f->seek_cache), 1u);
+
+        /* The same seek again is answered from the cache */
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime(f, 505, DIRECTION_DOWN, &o, &q));
+        ASSERT_EQ(le64toh(o->entry.realtime), 510u);
+        ASSERT_EQ(p, q);
+        ASSERT_EQ(ordered_hashmap_size(f->seek_cache), 1u);
+
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime(f, 505, DIRECTION_UP, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 500u);
+        ASSERT_EQ(ordered_hashmap_size(f->seek_cache), 2u);
+
+        ASSERT_OK_ZERO(journal_file_move_to_entry_by_realtime(f, 1005, DIRECTION_DOWN, NULL, NULL));
+        ASSERT_OK_ZERO(journal_file_move_to_entry_by_realtime(f, 1005, DIRECTION_DOWN, NULL, NULL));
+
+        ASSERT_OK_POSITIVE(journal_file_find_data_object(f, test, strlen(test), &d, NULL));
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime_for_data(f, d, 333, DIRECTION_DOWN, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 340u);
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime_for_data(f, d, 333, DIRECTION_DOWN, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 340u);
+
+        /* Appending entries must not make us return stale results */
+        ts = (dual_timestamp) { .realtime = 1010, .monotonic = 1010 };
+        ASSERT_OK(journal_file_append_entry(f, &ts, NULL, &IOVEC_MAKE_STRING(test), 1, NULL, NULL, NULL, NULL));
+
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime(f, 1005, DIRECTION_DOWN, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 1010u);
+
+        ASSERT_OK_POSITIVE(journal_file_find_data_object(f, test, strlen(test), &d, NULL));
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime_for_data(f, d, 1005, DIRECTION_DOWN, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 1010u);
+
+        /* The cache is bounded */
+        for (uint64_t i = 0; i < 200; i++)
+                ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_seqnum(f, i % 101 + 1, DIRECTION_DOWN, NULL, NULL));
+        ASSERT_LE(ordered_hashmap_size(f->seek_cache), 64u);
+
+        (void) journal_file_offline_close(f);
+
+        if (arg_keep)
+                log_info("Not removing %s", t);
+        else
+                ASSERT_OK(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL));
+}
+
+TEST(seek_realtime_out_of_range) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        static const char test[] = "TEST1=1", test2[] = "TEST2=2";
+        JournalFile *f;
+        dual_timestamp ts;
+        char t[] = "/var/tmp/journal-XXXXXX";
+        Object *o, *d;
+
+        ASSERT_NOT_NULL(m = mmap_cache_new());
+
+        mkdtemp_chdir_chattr(t);
+
+        ASSERT_OK(journal_file_open(-EBADF, "test.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, NULL, &f));
+
+        for (uint64_t i = 1; i <= 10; i++) {
+                ts = (dual_timestamp) { .realtime = i * 10, .monotonic = i * 10 };
+                ASSERT_OK(journal_file_append_entry(f, &ts, NULL, &IOVEC_MAKE_STRING(i % 2 == 0 ? test : test2), 1, NULL, NULL, NULL, NULL));
+        }
+
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime(f, 5, DIRECTION_DOWN, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 10u);
+        ASSERT_OK_ZERO(journal_file_move_to_entry_by_realtime(f, 5, DIRECTION_UP, NULL, NULL));
+
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime(f, 500, DIRECTION_UP, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 100u);
+        ASSERT_OK_ZERO(journal_file_move_to_entry_by_realtime(f, 500, DIRECTION_DOWN, NULL, NULL));
+
+        ASSERT_OK_POSITIVE(journal_file_find_data_object(f, test, strlen(test), &d, NULL));
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime_for_data(f, d, 5, DIRECTION_DOWN, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 20u);
+        ASSERT_OK_ZERO(journal_file_move_to_entry_by_realtime_for_data(f, d, 5, DIRECTION_UP, NULL, NULL));
+
+        ASSERT_OK_POSITIVE(journal_file_find_data_object(f, test2, strlen(test2), &d, NULL));
+        ASSERT_OK_POSITIVE(journal_file_move_to_entry_by_realtime_for_data(f, d, 500, DIRECTION_UP, &o, NULL));
+        ASSERT_EQ(le64toh(o->entry.realtime), 90u);
+        ASSERT_OK_ZERO(journal_file_move_to_entry_by_realtime_for_data(f, d, 500, DIRECTION_DOWN, NULL, NULL));
+
+        (void) journal_file_offline_close(f);
+
+        if (arg_keep)
+                log_info("Not removing %s", t);
+        else
+                ASSERT_OK(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL));
+}
+
+TEST(allocate_fresh) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        static const char test[] = "TEST1=1";
+        JournalFile *f;
+        dual_timestamp ts;
+        char t[] = "/var/tmp/journal-XXXXXX";
+        struct stat st;
+
+        ASSERT_NOT_NULL(m = mmap_cache_new());
+
+        mkdtemp_chdir_chattr(t);
+
+        ASSERT_OK(journal_file_open(-EBADF, "test.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, NULL, &f));
+
+        /* Small files are grown in FILE_SIZE_INCREASE steps, hence a fresh one takes up 8MB */
+        ASSERT_OK_ERRNO(fstat(f->fd, &st));
+        ASSERT_EQ((uint64_t) st.st_size, 8 * U64_MB);
+
+        ts = (dual_timestamp) { .realtime = 10, .monotonic = 10 };
+        ASSERT_OK(journal_file_append_entry(f, &ts, NULL, &IOVEC_MAKE_STRING(test), 1, NULL, NULL, NULL, NULL));
+
+        ASSERT_OK_ERRNO(fstat(f->fd, &st));
+        ASSERT_EQ((uint64_t) st.st_size, 8 * U64_MB);
+
+        (void) journal_file_offline_close(f);
+
+        if (arg_keep)
+                log_info("Not removing %s", t);
+        else
+                ASSERT_OK(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL));
+}
+
 #if HAVE_COMPRESSION
 static bool check_compressed(uint64_t compress_threshold, uint64_t data_size) {
         _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
@@ -443,6 +443,33 @@ _public_ int sd_json_variant_new_string(sd_json_variant **ret, const char *s) {
         return sd_json_variant_new_stringn(ret, s, SIZE_MAX);
 }
 
+static int json_variant_new_string_validated(sd_json_variant **ret, const char *s) {
+        sd_json_variant *v;
+        size_t n;
+        int r;
+
+        /* Like sd_json_variant_new_string(), but for strings that the tokenizer already validated as UTF-8,
+         * hence let's not validate them a second time. */
+
+        assert(ret);
+        assert(s);
+
+        n = strlen(s);
+        if (n == 0) {
+                *ret = JSON_VARIANT_MAGIC_EMPTY_STRING;
+                return 0;
+        }
+
+        r = json_variant_new(&v, SD_JSON_VARIANT_STRING, n + 1);
+        if (r < 0)
+                return r;
+
+        memcpy(v->string, s, n + 1);
+
+        *ret = v;
+        return 0;
+}
+
 _public_ int sd_json_variant_new_base64(sd_json_variant **ret, const void *p, size_t n) {
         _cleanup_free_ char *s = NULL;
         ssize_t k;
@@ -1614,7 +1641,21 @@ static void json_format_string(FILE *f, const char *q, sd_json_format_flags_t fl
         if (flags & SD_JSON_FORMAT_COLOR)
                 fputs(ansi_green(), f);
 
-        for (; *q; q++)
+        for (;;) {
+                size_t n;
+
+                /* Write out runs of characters that need no escaping in one go */
+                n = strcspn(q, "\"\\"
+                            "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+                            "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f");
+                if (n > 0) {
+                        fwrite(q, 1, n, f);
+                        q += n;
+                }
+
+                if (!*q)
+                        break;
+
                 switch (*q) {
                 case '"':
                         fputs("\\\"", f);
@@ -1645,12 +1686,12 @@ static void json_format_string(FILE *f, const char *q, sd_json_format_flags_t fl
                         break;
 
                 default:
-                        if ((signed char) *q >= 0 && *q < ' ')
-                                fprintf(f, "\\u%04x", (unsigned) *q);
-                        else
-                                fputc(*q, f);
+                        fprintf(f, "\\u%04x", (unsigned) *q);
                 }
 
+                q++;
+        }
+
         if (flags & SD_JSON_FORMAT_COLOR)
                 fputs(ANSI_NORMAL, f);
 
@@ -2664,9 +2705,12 @@ static int json_parse_string(const char **p, char **ret) {
                                 if (!GREEDY_REALLOC(s, n + 5))
                                         return -ENOMEM;
 
-                                if (!utf16_is_surrogate(x))
+                                if (!utf16_is_surrogate(x)) {
+                                        if (!unichar_is_valid(x)) /* JSON strings must be valid UTF-8 */
+                                                return -EUCLEAN;
+
                                         n += utf8_encode_unichar(s + n, (char32_t) x);
-                                else if (utf16_is_trailing_surrogate(x))
+                                } else if (utf16_is_trailing_surrogate(x))
                                         return -EINVAL;
                                 else {
                                         char16_t y;
@@ -2683,7 +2727,11 @@ static int json_parse_string(const char **p, char **ret) {
                                         if (!utf16_is_trailing_surrogate(y))
                                                 return -EINVAL;
 
-                                        n += utf8_encode_unichar(s + n, utf16_surrogate_pair_to_unichar(x, y));
+                                        char32_t u = utf16_surrogate_pair_to_unichar(x, y);
+                                        if (!unichar_is_valid(u))
+                                                return -EUCLEAN;
+
+                                        n += utf8_encode_unichar(s + n, u);
                                 }
 
                                 continue;
@@ -3222,7 +3270,7 @@ static int json_parse_internal(
                                 goto finish;
                         }
 
-                        r = sd_json_variant_new_string(&add, string);
+                        r = json_variant_new_string_validated(&add, string);
                         if (r < 0)
                                 goto finish;
 
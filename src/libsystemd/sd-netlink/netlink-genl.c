@@ -285,7 +285,6 @@ static int genl_family_get_by_name_internal(
 
 static int genl_family_get_by_name(sd_netlink *nl, const char *name, const GenericNetlinkFamily **ret) {
         const GenericNetlinkFamily *f, *ctrl;
-        int r;
 
         assert(nl);
         assert(nl->protocol == NETLINK_GENERIC);
@@ -304,12 +303,10 @@ static int genl_family_get_by_name(sd_netlink *nl, const char *name, const Gener
         if (streq(name, CTRL_GENL_NAME))
                 return genl_family_get_by_name_internal(nl, &nlctrl_static, CTRL_GENL_NAME, ret);
 
-        ctrl = hashmap_get(nl->genl_family_by_name, CTRL_GENL_NAME);
-        if (!ctrl) {
-                r = genl_family_get_by_name_internal(nl, &nlctrl_static, CTRL_GENL_NAME, &ctrl);
-                if (r < 0)
-                        return r;
-        }
+        /* The ID of the controller family is fixed, and CTRL_CMD_GETFAMILY is understood by all versions of
+         * it, hence there's no need to resolve the controller itself first, which would cost another round
+         * trip. It is only resolved when explicitly requested, e.g. to subscribe to its multicast groups. */
+        ctrl = hashmap_get(nl->genl_family_by_name, CTRL_GENL_NAME) ?: &nlctrl_static;
 
         return genl_family_get_by_name_internal(nl, ctrl, name, ret);
 }
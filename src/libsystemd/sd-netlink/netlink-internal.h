@@ -125,6 +125,7 @@ struct sd_netlink_message {
         bool sealed:1;
 
         sd_netlink_message *next; /* next in a chain of multi-part messages */
+        sd_netlink_message *tail; /* last in the chain, only maintained while the chain is being received */
 };
 
 int message_new_empty(sd_netlink *nl, sd_netlink_message **ret);
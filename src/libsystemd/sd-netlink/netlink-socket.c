@@ -276,6 +276,8 @@ static int netlink_queue_partially_received_message(sd_netlink *nl, sd_netlink_m
         if (r < 0)
                 return r;
 
+        m->tail = m;
+
         sd_netlink_message_ref(m);
         return 0;
 }
@@ -396,10 +398,11 @@ int socket_read_message(sd_netlink *nl) {
                                 existing = hashmap_get(nl->rqueue_partial_by_serial, UINT32_TO_PTR(hdr->nlmsg_seq));
                                 if (existing) {
                                         /* This is the continuation of the previously read messages.
-                                         * Let's append this message at the end. */
-                                        while (existing->next)
-                                                existing = existing->next;
-                                        existing->next = TAKE_PTR(m);
+                                         * Let's append this message at the end. Dumps may consist of a huge
+                                         * number of parts, hence don't walk the chain to find its end. */
+                                        assert(existing->tail);
+                                        existing->tail->next = m;
+                                        existing->tail = TAKE_PTR(m);
                                 } else {
                                         /* This is the first message. Put it into the queue for partially
                                          * received messages. */
@@ -464,6 +464,12 @@ size_t netlink_get_reply_callback_count(sd_netlink *nl) {
         return hashmap_size(nl->reply_callbacks);
 }
 
+uint32_t netlink_get_port_id(sd_netlink *nl) {
+        assert(nl);
+
+        return nl->sockaddr.nl.nl_pid;
+}
+
 int sd_netlink_call_async(
                 sd_netlink *nl,
                 sd_netlink_slot **ret_slot,
@@ -1835,6 +1835,8 @@ static int varlink_idl_validate_symbol(const sd_varlink_symbol *symbol, sd_json_
         case SD_VARLINK_STRUCT_TYPE:
         case SD_VARLINK_METHOD:
         case SD_VARLINK_ERROR: {
+                size_t n_found = 0;
+
                 if (!sd_json_variant_is_object(v)) {
                         if (reterr_bad_field)
                                 *reterr_bad_field = symbol->name;
@@ -1849,14 +1851,24 @@ static int varlink_idl_validate_symbol(const sd_varlink_symbol *symbol, sd_json_
                         if (field->field_direction != direction)
                                 continue;
 
-                        r = varlink_idl_validate_field(field, sd_json_variant_by_key(v, field->name));
+                        sd_json_variant *e = sd_json_variant_by_key(v, field->name);
+
+                        r = varlink_idl_validate_field(field, e);
                         if (r < 0) {
                                 if (reterr_bad_field)
                                         *reterr_bad_field = field->name;
                                 return r;
                         }
+
+                        if (e)
+                                n_found++;
                 }
 
+                /* Field names are unique per direction, hence if every key of the object matched one of
+                 * the fields above, there can't be any unknown ones, and we can skip the lookups below. */
+                if (n_found == sd_json_variant_elements(v) / 2)
+                        break;
+
                 _unused_ sd_json_variant *e;
                 const char *name;
                 JSON_VARIANT_OBJECT_FOREACH(name, e, v) {
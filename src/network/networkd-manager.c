@@ -301,8 +301,21 @@ static int manager_setup_rtnl_filter(Manager *manager) {
                 BPF_STMT(BPF_LD + BPF_H + BPF_ABS, offsetof(struct nlmsghdr, nlmsg_flags)), /* A <- message flags */
                 BPF_JUMP(BPF_JMP + BPF_JSET + BPF_K, htobe16(NLM_F_MULTI), 0, 1),           /* message flags has NLM_F_MULTI ? */
                 BPF_STMT(BPF_RET + BPF_K, UINT32_MAX),                                      /* accept */
-                /* Accept all message types except for RTM_NEWNEIGH or RTM_DELNEIGH. */
                 BPF_STMT(BPF_LD + BPF_H + BPF_ABS, offsetof(struct nlmsghdr, nlmsg_type)),  /* A <- message type */
+                /* When foreign routes are not managed, reject RTM_NEWROUTE triggered by other processes, to
+                 * not wake up for each route set by e.g. a routing daemon. Routes configured by us or the
+                 * kernel are still accepted. RTM_DELROUTE is always accepted, as we need to forget routes
+                 * removed by others. */
+                BPF_JUMP(BPF_JMP + BPF_JA + BPF_K, manager->manage_foreign_routes ? 6 : 0, 0, 0),
+                                                                                            /* skip route checks ? */
+                BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, htobe16(RTM_NEWROUTE), 0, 5),           /* message type == RTM_NEWROUTE ? */
+                BPF_STMT(BPF_LD + BPF_W + BPF_ABS, offsetof(struct nlmsghdr, nlmsg_pid)),   /* A <- sender port ID */
+                BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, 0, 2, 0),                               /* sent by the kernel ? */
+                BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, htobe32(netlink_get_port_id(manager->rtnl)), 1, 0),
+                                                                                            /* triggered by us ? */
+                BPF_STMT(BPF_RET + BPF_K, 0),                                               /* reject */
+                BPF_STMT(BPF_RET + BPF_K, UINT32_MAX),                                      /* accept */
+                /* Accept all message types except for RTM_NEWNEIGH or RTM_DELNEIGH. */
                 BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, htobe16(RTM_NEWNEIGH), 2, 0),           /* message type == RTM_NEWNEIGH ? */
                 BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, htobe16(RTM_DELNEIGH), 1, 0),           /* message type == RTM_DELNEIGH ? */
                 BPF_STMT(BPF_RET + BPF_K, UINT32_MAX),                                      /* accept */
@@ -418,7 +431,7 @@ static int manager_connect_rtnl(Manager *m, int fd) {
         if (r < 0)
                 return r;
 
-        return manager_setup_rtnl_filter(m);
+        return 0;
 }
 
 static int manager_post_handler(sd_event_source *s, void *userdata) {
@@ -1046,6 +1059,11 @@ int manager_enumerate(Manager *m) {
 
         log_debug("Enumerating...");
 
+        /* The filter depends on networkd.conf, hence attach it only after the file is parsed. */
+        r = manager_setup_rtnl_filter(m);
+        if (r < 0)
+                return log_error_errno(r, "Could not attach filter to rtnl socket: %m");
+
         r = manager_enumerate_links(m);
         if (r < 0)
                 return log_error_errno(r, "Could not enumerate links: %m");
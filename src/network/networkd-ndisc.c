@@ -682,6 +682,47 @@ static int ndisc_address_handler(sd_netlink *rtnl, sd_netlink_message *m, Reques
         return 1;
 }
 
+static bool ndisc_address_lifetime_equal(usec_t existing, usec_t requesting, usec_t now_usec) {
+        /* Lifetimes which both have already passed are equivalent, e.g. the preferred lifetime of a
+         * deprecated address. */
+        return existing == requesting || (existing <= now_usec && requesting <= now_usec);
+}
+
+static bool ndisc_address_is_unchanged(const Address *existing, const Address *address) {
+        usec_t now_usec;
+
+        assert(existing);
+        assert(address);
+
+        /* Routers repeat the same RA periodically. Usually this extends the lifetime of the address, and we
+         * need to tell the kernel about it. However, if the prefix is advertised with infinite lifetimes, or
+         * the lifetimes are kept as is (see ndisc_address_set_lifetime()), then there is nothing to update,
+         * and we can avoid a pointless netlink roundtrip for each RA. */
+
+        if (existing->source != NETWORK_CONFIG_SOURCE_NDISC)
+                return false;
+
+        if (!address_is_ready(existing))
+                return false;
+
+        if (!in6_addr_equal(&existing->provider.in6, &address->provider.in6))
+                return false;
+
+        /* The kernel may set some more flags, e.g. IFA_F_PERMANENT or IFA_F_DEPRECATED. */
+        if (!FLAGS_SET(existing->flags, address->flags))
+                return false;
+
+        if (existing->route_metric != address->route_metric)
+                return false;
+
+        if (!streq_ptr(existing->netlabel, address->netlabel))
+                return false;
+
+        now_usec = now(CLOCK_BOOTTIME);
+        return ndisc_address_lifetime_equal(existing->lifetime_valid_usec, address->lifetime_valid_usec, now_usec) &&
+                ndisc_address_lifetime_equal(existing->lifetime_preferred_usec, address->lifetime_preferred_usec, now_usec);
+}
+
 static int ndisc_request_address(Address *address, Link *link) {
         bool is_new;
         int r;
@@ -698,9 +739,12 @@ static int ndisc_request_address(Address *address, Link *link) {
         Address *existing;
         if (address_get_harder(link, address, &existing) < 0)
                 is_new = true;
-        else if (address_can_update(existing, address))
+        else if (address_can_update(existing, address)) {
+                if (ndisc_address_is_unchanged(existing, address))
+                        return 0;
+
                 is_new = false;
-        else if (existing->source == NETWORK_CONFIG_SOURCE_DHCP6) {
+        } else if (existing->source == NETWORK_CONFIG_SOURCE_DHCP6) {
                 /* SLAAC address is preferred over DHCPv6 address. */
                 log_link_debug(link, "Conflicting DHCPv6 address %s exists, removing.",
                                IN_ADDR_PREFIX_TO_STRING(existing->family, &existing->in_addr, existing->prefixlen));
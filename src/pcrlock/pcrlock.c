@@ -46,6 +46,7 @@
 #include "proc-cmdline.h"
 #include "random-util.h"
 #include "recovery-key.h"
+#include "set.h"
 #include "sort-util.h"
 #include "string-table.h"
 #include "terminal-util.h"
@@ -4061,6 +4062,7 @@ static int event_log_predict_pcrs(
                 uint32_t pcr,
                 const char *path) {
 
+        _cleanup_set_free_ Set *seen = NULL;
         EventLogComponent *component;
         int count = 0, r;
 
@@ -4112,6 +4114,13 @@ static int event_log_predict_pcrs(
                 if (r < 0)
                         return r;
 
+                /* Variants frequently have the same effect on this PCR, typically because they don't measure
+                 * anything into it at all. Everything that follows only depends on the PCR value reached so
+                 * far, hence descend only once per distinct value, rather than once per variant. Otherwise
+                 * we'd enumerate the combinations of all components for every single PCR. */
+                if (set_contains(seen, result))
+                        continue;
+
                 r = event_log_predict_pcrs(
                                 el,
                                 context,
@@ -4123,6 +4132,10 @@ static int event_log_predict_pcrs(
                         return r;
 
                 count += r;
+
+                r = set_ensure_consume(&seen, &tpm2_pcr_prediction_result_hash_ops, TAKE_PTR(result));
+                if (r < 0)
+                        return log_oom();
         }
 
         return count;
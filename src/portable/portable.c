@@ -121,10 +121,30 @@ PortableMetadata *portable_metadata_unref(PortableMetadata *i) {
         free(i->source);
         free(i->image_path);
         free(i->selinux_label);
+        strv_free(i->release_fields);
 
         return mfree(i);
 }
 
+static int portable_metadata_get_release_fields(PortableMetadata *m, char ***ret) {
+        int r;
+
+        assert(m);
+        assert(ret);
+
+        /* The release files are needed once for validation and then again for each attached unit, hence
+         * parse them only once. The returned strv is owned by the metadata object. */
+
+        if (!m->release_fields) {
+                r = load_env_file_pairs_fd(m->fd, m->name, &m->release_fields);
+                if (r < 0)
+                        return r;
+        }
+
+        *ret = m->release_fields;
+        return 0;
+}
+
 static int compare_metadata(PortableMetadata *const *x, PortableMetadata *const *y) {
         return strcmp((*x)->name, (*y)->name);
 }
@@ -568,7 +588,7 @@ static int extract_image_and_extensions(
                 char ***ret_valid_prefixes,
                 sd_bus_error *error) {
 
-        _cleanup_free_ char *id = NULL, *version_id = NULL, *sysext_level = NULL, *confext_level = NULL;
+        const char *id = NULL, *version_id = NULL, *sysext_level = NULL, *confext_level = NULL;
         _cleanup_(portable_metadata_unrefp) PortableMetadata *os_release = NULL;
         _cleanup_ordered_hashmap_free_ OrderedHashmap *extension_images = NULL, *extension_releases = NULL;
         _cleanup_(pick_result_done) PickResult result = PICK_RESULT_NULL;
@@ -666,16 +686,19 @@ static int extract_image_and_extensions(
          * extension-release metadata match, otherwise reject it immediately as invalid, or it will fail when
          * the units are started. Also, collect valid portable prefixes if caller requested that. */
         if (validate_extension || ret_valid_prefixes) {
-                _cleanup_free_ char *prefixes = NULL;
-
-                r = parse_env_file_fd(os_release->fd, os_release->name,
-                                     "ID", &id,
-                                     "VERSION_ID", &version_id,
-                                     "SYSEXT_LEVEL", &sysext_level,
-                                     "CONFEXT_LEVEL", &confext_level,
-                                     "PORTABLE_PREFIXES", &prefixes);
+                const char *prefixes;
+                char **fields;
+
+                r = portable_metadata_get_release_fields(os_release, &fields);
                 if (r < 0)
                         return r;
+
+                id = strv_env_pairs_get(fields, "ID");
+                version_id = strv_env_pairs_get(fields, "VERSION_ID");
+                sysext_level = strv_env_pairs_get(fields, "SYSEXT_LEVEL");
+                confext_level = strv_env_pairs_get(fields, "CONFEXT_LEVEL");
+                prefixes = strv_env_pairs_get(fields, "PORTABLE_PREFIXES");
+
                 if (isempty(id))
                         return sd_bus_error_set_errnof(error, ESTALE, "Image %s os-release metadata lacks the ID field", name_or_path);
 
@@ -689,7 +712,7 @@ static int extract_image_and_extensions(
         ORDERED_HASHMAP_FOREACH(ext, extension_images) {
                 _cleanup_(portable_metadata_unrefp) PortableMetadata *extension_release_meta = NULL;
                 _cleanup_hashmap_free_ Hashmap *extra_unit_files = NULL;
-                _cleanup_strv_free_ char **extension_release = NULL;
+                char **extension_release;
                 const char *e;
 
                 r = portable_extract_by_path(
@@ -712,7 +735,7 @@ static int extract_image_and_extensions(
                 if (!validate_extension && !ret_valid_prefixes && !ret_extension_releases)
                         continue;
 
-                r = load_env_file_pairs_fd(extension_release_meta->fd, extension_release_meta->name, &extension_release);
+                r = portable_metadata_get_release_fields(extension_release_meta, &extension_release);
                 if (r < 0)
                         return r;
 
@@ -1039,7 +1062,7 @@ static int make_marker_text(const char *image_path, OrderedHashmap *extension_im
 
 static int append_release_log_fields(
                 char **text,
-                const PortableMetadata *release,
+                PortableMetadata *release,
                 ImageClass type,
                 const char *field_name) {
 
@@ -1053,8 +1076,8 @@ static int append_release_log_fields(
                  [IMAGE_SYSEXT] = { "SYSEXT_IMAGE_ID", "SYSEXT_ID", NULL },
                  [IMAGE_CONFEXT] = { "CONFEXT_IMAGE_ID", "CONFEXT_ID", NULL },
         };
-        _cleanup_strv_free_ char **fields = NULL;
         const char *id = NULL, *version = NULL;
+        char **fields;
         int r;
 
         assert(IN_SET(type, IMAGE_PORTABLE, IMAGE_SYSEXT, IMAGE_CONFEXT));
@@ -1066,7 +1089,7 @@ static int append_release_log_fields(
         if (!release)
                 return 0; /* Nothing to do. */
 
-        r = load_env_file_pairs_fd(release->fd, release->name, &fields);
+        r = portable_metadata_get_release_fields(release, &fields);
         if (r < 0)
                 return log_debug_errno(r, "Failed to parse '%s': %m", release->name);
 
@@ -1099,7 +1122,7 @@ static int install_chroot_dropin(
                 OrderedHashmap *extension_images,
                 OrderedHashmap *extension_releases,
                 const PortableMetadata *m,
-                const PortableMetadata *os_release,
+                PortableMetadata *os_release,
                 const char *dropin_dir,
                 PortableFlags flags,
                 char **ret_dropin,
@@ -1306,7 +1329,7 @@ static int attach_unit_file(
                 OrderedHashmap *extension_images,
                 OrderedHashmap *extension_releases,
                 const PortableMetadata *m,
-                const PortableMetadata *os_release,
+                PortableMetadata *os_release,
                 const char *profile,
                 PortableFlags flags,
                 PortableChange **changes,
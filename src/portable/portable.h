@@ -15,6 +15,7 @@ typedef struct PortableMetadata {
         char *source;
         char *image_path;
         char *selinux_label;
+        char **release_fields; /* For os-release and extension-release files: the parsed contents, cached */
         char name[];
 } PortableMetadata;
 
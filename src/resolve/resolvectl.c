@@ -1199,12 +1199,14 @@ static int show_statistics(int argc, char **argv, void *userdata) {
                 uint64_t cache_size;
                 uint64_t n_cache_hit;
                 uint64_t n_cache_miss;
-        } cache;
+                uint64_t n_cache_evicted;
+        } cache = {};
 
         static const sd_json_dispatch_field cache_dispatch_table[] = {
-                { "size",   _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, cache_size),   SD_JSON_MANDATORY },
-                { "hits",   _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, n_cache_hit),  SD_JSON_MANDATORY },
-                { "misses", _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, n_cache_miss), SD_JSON_MANDATORY },
+                { "size",      _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, cache_size),      SD_JSON_MANDATORY },
+                { "hits",      _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, n_cache_hit),     SD_JSON_MANDATORY },
+                { "misses",    _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, n_cache_miss),    SD_JSON_MANDATORY },
+                { "evictions", _SD_JSON_VARIANT_TYPE_INVALID, sd_json_dispatch_uint64, offsetof(struct cache, n_cache_evicted), 0                 },
                 {},
         };
 
@@ -1258,6 +1260,8 @@ static int show_statistics(int argc, char **argv, void *userdata) {
                            TABLE_UINT64, cache.n_cache_hit,
                            TABLE_FIELD, "Cache Misses",
                            TABLE_UINT64, cache.n_cache_miss,
+                           TABLE_FIELD, "Cache Evictions",
+                           TABLE_UINT64, cache.n_cache_evicted,
                            TABLE_EMPTY, TABLE_EMPTY,
                            TABLE_STRING, "Failure Transactions",
                            TABLE_SET_COLOR, ansi_highlight(),
@@ -199,6 +199,7 @@ static void dns_cache_make_space(DnsCache *c, unsigned add) {
                  * doesn't go away in the middle of the remove call */
                 key = dns_resource_key_ref(i->key);
                 dns_cache_remove_by_key(c, key);
+                c->n_evicted++;
         }
 }
 
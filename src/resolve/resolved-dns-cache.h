@@ -13,6 +13,7 @@ typedef struct DnsCache {
         Prioq *by_expiry;
         unsigned n_hit;
         unsigned n_miss;
+        unsigned n_evicted;
 } DnsCache;
 
 #include "resolved-dns-answer.h"
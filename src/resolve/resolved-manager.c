@@ -1934,7 +1934,7 @@ int socket_disable_pmtud(int fd, int af) {
 }
 
 int dns_manager_dump_statistics_json(Manager *m, sd_json_variant **ret) {
-        uint64_t size = 0, hit = 0, miss = 0;
+        uint64_t size = 0, hit = 0, miss = 0, evicted = 0;
 
         assert(m);
         assert(ret);
@@ -1943,6 +1943,7 @@ int dns_manager_dump_statistics_json(Manager *m, sd_json_variant **ret) {
                 size += dns_cache_size(&s->cache);
                 hit += s->cache.n_hit;
                 miss += s->cache.n_miss;
+                evicted += s->cache.n_evicted;
         }
 
         return sd_json_buildo(ret,
@@ -1957,7 +1958,8 @@ int dns_manager_dump_statistics_json(Manager *m, sd_json_variant **ret) {
                               SD_JSON_BUILD_PAIR("cache", SD_JSON_BUILD_OBJECT(
                                                                  SD_JSON_BUILD_PAIR_UNSIGNED("size", size),
                                                                  SD_JSON_BUILD_PAIR_UNSIGNED("hits", hit),
-                                                                 SD_JSON_BUILD_PAIR_UNSIGNED("misses", miss)
+                                                                 SD_JSON_BUILD_PAIR_UNSIGNED("misses", miss),
+                                                                 SD_JSON_BUILD_PAIR_UNSIGNED("evictions", evicted)
                                                  )),
                               SD_JSON_BUILD_PAIR("dnssec", SD_JSON_BUILD_OBJECT(
                                                                  SD_JSON_BUILD_PAIR_UNSIGNED("secure", m->n_dnssec_verdict[DNSSEC_SECURE]),
@@ -1972,7 +1974,7 @@ void dns_manager_reset_statistics(Manager *m) {
         assert(m);
 
         LIST_FOREACH(scopes, s, m->dns_scopes)
-                s->cache.n_hit = s->cache.n_miss = 0;
+                s->cache.n_hit = s->cache.n_miss = s->cache.n_evicted = 0;
 
         m->n_transactions_total = 0;
         m->n_timeouts_total = 0;
@@ -249,6 +249,21 @@ static bool sender_on_local_subnet(DnsScope *s, DnsPacket *p) {
         return false;
 }
 
+bool mdns_is_known_answer(DnsPacket *p, DnsResourceRecord *rr) {
+        DnsResourceRecord *known;
+
+        assert(p);
+        assert(rr);
+
+        /* RFC 6762, section 7.1: a responder must not answer with a record which the querier listed in the
+         * answer section of its query, as long as the TTL given there is at least half of the true TTL. */
+        DNS_ANSWER_FOREACH(known, p->answer)
+                if ((uint64_t) known->ttl * 2 >= rr->ttl && dns_resource_record_equal(known, rr) > 0)
+                        return true;
+
+        return false;
+}
+
 static int mdns_scope_process_query(DnsScope *s, DnsPacket *p) {
         _cleanup_(dns_answer_unrefp) DnsAnswer *full_answer = NULL;
         _cleanup_(dns_packet_unrefp) DnsPacket *reply = NULL;
@@ -328,6 +343,10 @@ static int mdns_scope_process_query(DnsScope *s, DnsPacket *p) {
 
                 DNS_ANSWER_FOREACH_ITEM(item, answer) {
                         DnsAnswerFlags flags = item->flags | DNS_ANSWER_REFUSE_TTL_NO_MATCH;
+
+                        if (mdns_is_known_answer(p, item->rr))
+                                continue;
+
                         /* The cache-flush bit must not be set in legacy unicast responses.
                          * See section 6.7 of RFC 6762. */
                         if (legacy_query)
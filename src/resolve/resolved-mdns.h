@@ -12,3 +12,5 @@ int manager_mdns_ipv6_fd(Manager *m);
 void manager_mdns_stop(Manager *m);
 void manager_mdns_maybe_stop(Manager *m);
 int manager_mdns_start(Manager *m);
+
+bool mdns_is_known_answer(DnsPacket *p, DnsResourceRecord *rr);
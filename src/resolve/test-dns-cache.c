@@ -179,6 +179,25 @@ TEST(dns_a_success_non_matching_name_is_cached) {
         ASSERT_FALSE(dns_cache_is_empty(&cache));
 }
 
+TEST(dns_cache_put_evicts_when_full) {
+        _cleanup_(dns_cache_unrefp) DnsCache cache = new_cache();
+
+        for (unsigned i = 0; i < 5000; i++) {
+                _cleanup_(put_args_unrefp) PutArgs put_args = mk_put_args();
+                _cleanup_free_ char *name = NULL;
+
+                ASSERT_OK(asprintf(&name, "host%u.example.com", i));
+                put_args.key = dns_resource_key_new(DNS_CLASS_IN, DNS_TYPE_A, name);
+                ASSERT_NOT_NULL(put_args.key);
+                answer_add_a(&put_args, put_args.key, 0xc0a80100 + i, 3600, DNS_ANSWER_CACHEABLE);
+
+                ASSERT_OK(cache_put(&cache, &put_args));
+        }
+
+        ASSERT_LT(dns_cache_size(&cache), 5000u);
+        ASSERT_EQ(cache.n_evicted, 5000u - dns_cache_size(&cache));
+}
+
 TEST(dns_a_success_mdns_no_key_is_cached) {
         _cleanup_(dns_cache_unrefp) DnsCache cache = new_cache();
         _cleanup_(put_args_unrefp) PutArgs put_args = mk_put_args();
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include "resolved-dns-packet.h"
+#include "resolved-dns-rr.h"
+#include "resolved-mdns.h"
+
+#include "log.h"
+#include "tests.h"
+
+static DnsResourceRecord* make_a(const char *name, uint32_t address, uint32_t ttl) {
+        DnsResourceRecord *rr;
+
+        ASSERT_NOT_NULL(rr = dns_resource_record_new_full(DNS_CLASS_IN, DNS_TYPE_A, name));
+        rr->ttl = ttl;
+        rr->a.in_addr.s_addr = htobe32(address);
+
+        return rr;
+}
+
+static DnsPacket* make_query(DnsResourceRecord **known, size_t n_known) {
+        _cleanup_(dns_resource_key_unrefp) DnsResourceKey *key = NULL;
+        _cleanup_(dns_packet_unrefp) DnsPacket *p = NULL;
+
+        /* A query for the A records of myhost.local, listing the answers the querier already knows */
+
+        ASSERT_OK(dns_packet_new_query(&p, DNS_PROTOCOL_MDNS, 0, /* dnssec_checking_disabled= */ false));
+
+        ASSERT_NOT_NULL(key = dns_resource_key_new(DNS_CLASS_IN, DNS_TYPE_A, "myhost.local"));
+        ASSERT_OK(dns_packet_append_key(p, key, /* flags= */ 0, NULL));
+        DNS_PACKET_HEADER(p)->qdcount = htobe16(1);
+
+        FOREACH_ARRAY(rr, known, n_known)
+                ASSERT_OK(dns_packet_append_rr(p, *rr, /* flags= */ 0, NULL, NULL));
+        DNS_PACKET_HEADER(p)->ancount = htobe16(n_known);
+
+        ASSERT_OK(dns_packet_extract(p));
+        ASSERT_EQ(dns_question_size(p->question), 1u);
+        ASSERT_EQ(dns_answer_size(p->answer), n_known);
+
+        return TAKE_PTR(p);
+}
+
+static bool is_known_answer(DnsPacket *p, const char *name, uint32_t address, uint32_t ttl) {
+        _cleanup_(dns_resource_record_unrefp) DnsResourceRecord *rr = make_a(name, address, ttl);
+
+        return mdns_is_known_answer(p, rr);
+}
+
+TEST(mdns_is_known_answer_none) {
+        _cleanup_(dns_packet_unrefp) DnsPacket *p = make_query(NULL, 0);
+
+        ASSERT_FALSE(is_known_answer(p, "myhost.local", 0xc0a80101, 120));
+}
+
+TEST(mdns_is_known_answer_ttl) {
+        _cleanup_(dns_resource_record_unrefp) DnsResourceRecord *a = NULL, *b = NULL, *c = NULL;
+        _cleanup_(dns_packet_unrefp) DnsPacket *p = NULL;
+
+        a = make_a("myhost.local", 0xc0a80101, 60);
+        b = make_a("myhost.local", 0xc0a80102, 59);
+        c = make_a("myhost.local", 0xc0a80103, 120);
+        p = make_query((DnsResourceRecord*[]) { a, b, c }, 3);
+
+        /* RFC 6762, section 7.1: a known answer suppresses ours as long as its TTL is at least half of the
+         * TTL we would announce. */
+        ASSERT_TRUE(is_known_answer(p, "myhost.local", 0xc0a80101, 60));
+        ASSERT_TRUE(is_known_answer(p, "myhost.local", 0xc0a80101, 119));
+        ASSERT_TRUE(is_known_answer(p, "myhost.local", 0xc0a80101, 120));
+        ASSERT_FALSE(is_known_answer(p, "myhost.local", 0xc0a80101, 121));
+        ASSERT_FALSE(is_known_answer(p, "myhost.local", 0xc0a80101, 4500));
+
+        ASSERT_TRUE(is_known_answer(p, "myhost.local", 0xc0a80102, 118));
+        ASSERT_FALSE(is_known_answer(p, "myhost.local", 0xc0a80102, 119));
+        ASSERT_FALSE(is_known_answer(p, "myhost.local", 0xc0a80102, 120));
+
+        /* A TTL longer than ours is fine, too */
+        ASSERT_TRUE(is_known_answer(p, "myhost.local", 0xc0a80103, 60));
+
+        /* The name and the data have to match */
+        ASSERT_FALSE(is_known_answer(p, "myhost.local", 0xc0a80104, 60));
+        ASSERT_FALSE(is_known_answer(p, "otherhost.local", 0xc0a80101, 60));
+        ASSERT_TRUE(is_known_answer(p, "MyHost.local", 0xc0a80101, 60));
+}
+
+DEFINE_TEST_MAIN(LOG_DEBUG);
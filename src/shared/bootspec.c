@@ -938,25 +938,20 @@ static int trim_cmdline(char **cmdline) {
  * the ones we do care about and we are willing to load into memory have this size limit.) */
 #define PE_SECTION_SIZE_MAX (4U*1024U*1024U)
 
-static int pe_find_uki_sections(
+static int pe_load_uki(
                 int fd,
                 const char *path,
-                unsigned profile,
-                char **ret_osrelease,
-                char **ret_profile,
-                char **ret_cmdline) {
+                IMAGE_SECTION_HEADER **ret_sections,
+                PeHeader **ret_pe_header) {
 
-        _cleanup_free_ char *osrelease_text = NULL, *profile_text = NULL, *cmdline_text = NULL;
         _cleanup_free_ IMAGE_SECTION_HEADER *sections = NULL;
         _cleanup_free_ PeHeader *pe_header = NULL;
         int r;
 
         assert(fd >= 0);
         assert(path);
-        assert(profile != UINT_MAX);
-        assert(ret_osrelease);
-        assert(ret_profile);
-        assert(ret_cmdline);
+        assert(ret_sections);
+        assert(ret_pe_header);
 
         r = pe_load_headers_and_sections(fd, path, &sections, &pe_header);
         if (r < 0)
@@ -966,7 +961,31 @@ static int pe_find_uki_sections(
                 return log_error_errno(SYNTHETIC_ERRNO(EBADMSG), "Parsed PE file '%s' is not a UKI.", path);
 
         if (!pe_is_native(pe_header)) /* Don't process non-native UKIs */
-                goto nothing;
+                return 0;
+
+        *ret_sections = TAKE_PTR(sections);
+        *ret_pe_header = TAKE_PTR(pe_header);
+        return 1;
+}
+
+static int pe_find_uki_sections(
+                int fd,
+                const PeHeader *pe_header,
+                const IMAGE_SECTION_HEADER *sections,
+                unsigned profile,
+                char **ret_osrelease,
+                char **ret_profile,
+                char **ret_cmdline) {
+
+        _cleanup_free_ char *osrelease_text = NULL, *profile_text = NULL, *cmdline_text = NULL;
+        int r;
+
+        assert(fd >= 0);
+        assert(pe_header);
+        assert(profile != UINT_MAX);
+        assert(ret_osrelease);
+        assert(ret_profile);
+        assert(ret_cmdline);
 
         /* Find part of the section table for this profile */
         size_t n_psections = 0;
@@ -1231,10 +1250,16 @@ static int boot_entries_find_unified(
                 if (!j)
                         return log_oom();
 
+                /* Load the headers and the section table only once, rather than for each profile */
+                _cleanup_free_ IMAGE_SECTION_HEADER *sections = NULL;
+                _cleanup_free_ PeHeader *pe_header = NULL;
+                if (pe_load_uki(fd, j, &sections, &pe_header) <= 0)
+                        continue;
+
                 for (unsigned p = 0; p < UNIFIED_PROFILES_MAX; p++) {
                         _cleanup_free_ char *osrelease = NULL, *profile = NULL, *cmdline = NULL;
 
-                        r = pe_find_uki_sections(fd, j, p, &osrelease, &profile, &cmdline);
+                        r = pe_find_uki_sections(fd, pe_header, sections, p, &osrelease, &profile, &cmdline);
                         if (r == 0) /* this profile does not exist, we are done */
                                 break;
                         if (r < 0)
@@ -1443,8 +1443,25 @@ int calendar_spec_next_usec(const CalendarSpec *spec, usec_t usec, usec_t *ret_n
 
         assert(spec);
 
-        if (isempty(spec->timezone))
-                return calendar_spec_next_usec_impl(spec, usec, ret_next);
+        if (isempty(spec->timezone)) {
+                if (spec->utc || getenv("TZ"))
+                        return calendar_spec_next_usec_impl(spec, usec, ret_next);
+
+                /* If $TZ is not set, glibc's mktime() stat()s /etc/localtime on every single invocation to
+                 * notice changes of the file, and find_next() calls mktime() a lot. Hence check the file
+                 * once, and then point $TZ to the very same file for the duration of the calculation: glibc
+                 * then sees that this is the zone it has already loaded, and doesn't look at the file
+                 * again. (Modifying the environment is not thread-safe, but calendar specs are only
+                 * evaluated in single-threaded programs.) */
+                tzset();
+
+                if (setenv("TZ", ":/etc/localtime", /* overwrite= */ true) < 0)
+                        return -errno;
+
+                r = calendar_spec_next_usec_impl(spec, usec, ret_next);
+                assert_se(unsetenv("TZ") >= 0);
+                return r;
+        }
 
         shared = mmap(NULL, sizeof *shared, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
         if (shared == MAP_FAILED)
@@ -295,6 +295,7 @@ int config_parse(
         _cleanup_fclose_ FILE *ours = NULL;
         unsigned line = 0, section_line = 0;
         bool section_ignored = false, bom_seen = false;
+        ReadLineFlags read_flags = 0;
         struct stat st;
         int r, fd;
 
@@ -332,12 +333,17 @@ int config_parse(
         } else
                 st = (struct stat) {};
 
+        /* A regular file can't be a TTY, let read_line_full() know, so that it doesn't call isatty() again
+         * for every single line. */
+        if (S_ISREG(st.st_mode))
+                read_flags |= READ_LINE_NOT_A_TTY;
+
         for (;;) {
                 _cleanup_free_ char *buf = NULL;
                 bool escaped = false;
                 char *l, *p, *e;
 
-                r = read_line(f, LONG_LINE_MAX, &buf);
+                r = read_line_full(f, LONG_LINE_MAX, read_flags, &buf);
                 if (r == 0)
                         break;
                 if (r == -ENOBUFS) {
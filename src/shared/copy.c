@@ -43,6 +43,9 @@
 /* If we copy via a userspace buffer, size it to 64K */
 #define COPY_BUFFER_SIZE (64U*U64_KB)
 
+/* With COPY_SPARSE we have to look at all data ourselves, hence use a larger buffer */
+#define COPY_SPARSE_BUFFER_SIZE (1U*U64_MB)
+
 /* If a byte progress function is specified during copying, never try to copy more than 1M, so that we can
  * reasonably call the progress function still */
 #define PROGRESS_STEP_SIZE (1U*U64_MB)
@@ -79,6 +82,42 @@ enum {
         FD_IS_NONBLOCKING_PIPE,
 };
 
+static int write_sparse_blocks(int fd, const uint8_t *buf, size_t n, size_t block_size) {
+        const uint8_t *w = buf, *e = buf + n;
+        int r;
+
+        assert(fd >= 0);
+        assert(buf || n == 0);
+        assert(block_size > 0);
+
+        /* Writes out the buffer, but seeks over each block that consists of NUL bytes only, so that it ends
+         * up as a hole. Shorter runs of NUL bytes are written out: a hole smaller than a file system block
+         * doesn't save anything, and would just cost us an extra lseek() and write() each. */
+
+        for (const uint8_t *q = buf; q < e; q += block_size) {
+                size_t l = MIN(block_size, (size_t) (e - q));
+
+                if (l < block_size || !memeqzero(q, l))
+                        continue;
+
+                if (q > w) {
+                        r = loop_write(fd, w, q - w);
+                        if (r < 0)
+                                return r;
+                }
+
+                if (lseek(fd, l, SEEK_CUR) < 0)
+                        return -errno;
+
+                w = q + l;
+        }
+
+        if (e > w)
+                return loop_write(fd, w, e - w);
+
+        return 0;
+}
+
 static int fd_is_nonblock_pipe(int fd) {
         struct stat st;
         int flags;
@@ -167,12 +206,15 @@ int copy_bytes_full(
 
         _cleanup_close_ int fdf_opened = -EBADF, fdt_opened = -EBADF;
         bool try_cfr = true, try_sendfile = true, try_splice = true;
+        _cleanup_free_ uint8_t *sparse_buf = NULL;
+        size_t sparse_block_size = 0;
         uint64_t copied_total = 0;
         int r, nonblock_pipe = -1;
 
         assert(fdf >= 0);
         assert(fdt >= 0);
         assert(!FLAGS_SET(copy_flags, COPY_LOCK_BSD));
+        assert(!FLAGS_SET(copy_flags, COPY_SPARSE) || (!ret_remains && !ret_remains_size));
 
         /* Tries to copy bytes from the file descriptor 'fdf' to 'fdt' in the smartest possible way. Copies a
          * maximum of 'max_bytes', which may be specified as UINT64_MAX, in which no maximum is applied.
@@ -195,6 +237,27 @@ int copy_bytes_full(
         if (fdt < 0)
                 return fdt;
 
+        /* The kernel-side copy calls write out every single byte, hence if we shall look for blocks of NUL
+         * bytes we have to look at the data ourselves. */
+        if (FLAGS_SET(copy_flags, COPY_SPARSE)) {
+                struct stat st;
+
+                try_cfr = try_sendfile = try_splice = false;
+
+                if (fstat(fdt, &st) < 0)
+                        return -errno;
+
+                /* Only whole file system blocks can become holes. The buffer size needs to be a multiple of
+                 * the block size, so that the blocks we look at stay aligned from one read to the next. */
+                sparse_block_size = st.st_blksize;
+                if (sparse_block_size <= 0 || COPY_SPARSE_BUFFER_SIZE % sparse_block_size != 0)
+                        sparse_block_size = page_size();
+
+                sparse_buf = malloc(COPY_SPARSE_BUFFER_SIZE);
+                if (!sparse_buf)
+                        return -ENOMEM;
+        }
+
         /* Try btrfs reflinks first. This only works on regular, seekable files, hence let's check the file offsets of
          * source and destination first. */
         if ((copy_flags & COPY_REFLINK)) {
@@ -459,6 +522,22 @@ int copy_bytes_full(
                                 goto next;
                 }
 
+                if (FLAGS_SET(copy_flags, COPY_SPARSE)) {
+                        /* Fill the whole buffer, so that we look at the data in well aligned blocks, even if
+                         * the source is a pipe that returns less on each read(). */
+                        n = loop_read(fdf, sparse_buf, MIN(m, COPY_SPARSE_BUFFER_SIZE), /* do_poll = */ true);
+                        if (n < 0)
+                                return n;
+                        if (n == 0) /* EOF */
+                                break;
+
+                        r = write_sparse_blocks(fdt, sparse_buf, n, sparse_block_size);
+                        if (r < 0)
+                                return r;
+
+                        goto next;
+                }
+
                 /* As a fallback just copy bits by hand */
                 {
                         uint8_t buf[MIN(m, COPY_BUFFER_SIZE)], *p = buf;
@@ -532,6 +611,21 @@ int copy_bytes_full(
 
                 if (ftruncate(fdt, off) < 0)
                         return -errno;
+
+        } else if (copy_flags & COPY_SPARSE) {
+                struct stat st;
+
+                /* If the data ended in a run of NUL bytes we only seeked over it, hence extend the file up to
+                 * here. */
+                off_t off = lseek(fdt, 0, SEEK_CUR);
+                if (off < 0)
+                        return -errno;
+
+                if (fstat(fdt, &st) < 0)
+                        return -errno;
+
+                if (st.st_size < off && ftruncate(fdt, off) < 0)
+                        return -errno;
         }
 
         return max_bytes <= 0; /* return 0 if we hit EOF earlier than the size limit */
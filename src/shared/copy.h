@@ -40,6 +40,7 @@ typedef enum CopyFlags {
          * copy because reflinking from COW to NOCOW files is not supported.
          */
         COPY_NOCOW_AFTER                  = 1 << 20,
+        COPY_SPARSE                       = 1 << 21, /* Turn runs of NUL bytes into holes, for sources that can't tell us about their holes (e.g. pipes) */
 } CopyFlags;
 
 typedef enum DenyType {
@@ -4,6 +4,7 @@
 #include <errno.h>
 #include <sys/prctl.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <stdio.h>
 
@@ -30,6 +31,7 @@
 #include "string-util.h"
 #include "strv.h"
 #include "terminal-util.h"
+#include "time-util.h"
 #include "tmpfile-util.h"
 
 #define EXIT_SKIP_REMAINING 77
@@ -101,6 +103,7 @@ static int do_execute(
 
         _cleanup_hashmap_free_ Hashmap *pids = NULL;
         bool parallel_execution;
+        usec_t start;
         int r;
 
         /* We fork this all off from a child process so that we can somewhat cleanly make use of SIGALRM
@@ -124,6 +127,8 @@ static int do_execute(
                 if (putenv(*e) != 0)
                         return log_error_errno(errno, "Failed to set environment variable: %m");
 
+        start = now(CLOCK_MONOTONIC);
+
         STRV_FOREACH(path, paths) {
                 _cleanup_free_ char *t = NULL;
                 _cleanup_close_ int fd = -EBADF;
@@ -182,6 +187,10 @@ static int do_execute(
                         r = wait_for_terminate_and_check(t, pid, WAIT_LOG_ABNORMAL);
                         if (r < 0)
                                 return r;
+
+                        log_debug("%s finished after %s.", t, FORMAT_TIMESPAN(usec_sub_unsigned(now(CLOCK_MONOTONIC), start), USEC_PER_MSEC));
+                        start = now(CLOCK_MONOTONIC);
+
                         if (r > 0) {
                                 if (FLAGS_SET(flags, EXEC_DIR_SKIP_REMAINING) && r == EXIT_SKIP_REMAINING) {
                                         log_info("%s succeeded with exit status %i, not executing remaining executables.", *path, r);
@@ -217,16 +226,31 @@ static int do_execute(
 
         while (!hashmap_isempty(pids)) {
                 _cleanup_free_ char *t = NULL;
-                pid_t pid;
-                void *p;
+                siginfo_t si = {};
+
+                /* Collect the children in the order they finish rather than in hashmap order, so that a
+                 * failure is reported as soon as it happens, and so that we can tell how long each one
+                 * took. Since we are running in our own process, all our children are the ones we forked
+                 * above. */
+                if (waitid(P_ALL, 0, &si, WEXITED|WNOWAIT) < 0) {
+                        if (errno == EINTR)
+                                continue;
 
-                t = ASSERT_PTR(hashmap_steal_first_key_and_value(pids, &p));
-                pid = PTR_TO_PID(p);
-                assert(pid > 0);
+                        return log_error_errno(errno, "Failed to wait for children: %m");
+                }
 
-                r = wait_for_terminate_and_check(t, pid, WAIT_LOG);
+                t = hashmap_remove(pids, PID_TO_PTR(si.si_pid));
+                if (!t) {
+                        (void) wait_for_terminate(si.si_pid, NULL);
+                        continue;
+                }
+
+                r = wait_for_terminate_and_check(t, si.si_pid, WAIT_LOG);
                 if (r < 0)
                         return r;
+
+                log_debug("%s finished after %s.", t, FORMAT_TIMESPAN(usec_sub_unsigned(now(CLOCK_MONOTONIC), start), USEC_PER_MSEC));
+
                 if (!FLAGS_SET(flags, EXEC_DIR_IGNORE_ERRORS) && r > 0)
                         return r;
         }
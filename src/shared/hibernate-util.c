@@ -198,28 +198,39 @@ static void swap_entries_done(SwapEntries *entries) {
         free(entries->swaps);
 }
 
-static int swap_entry_get_resume_config(SwapEntry *swap) {
+static int swap_entry_open(const SwapEntry *swap, struct stat *ret_st) {
         _cleanup_close_ int fd = -EBADF;
-        uint64_t offset_raw;
-        struct stat st;
-        int r;
 
         assert(swap);
         assert(swap->path);
+        assert(ret_st);
 
         fd = open(swap->path, O_RDONLY|O_CLOEXEC|O_NONBLOCK|O_NOCTTY);
         if (fd < 0)
                 return -errno;
 
-        if (fstat(fd, &st) < 0)
+        if (fstat(fd, ret_st) < 0)
                 return -errno;
 
+        return TAKE_FD(fd);
+}
+
+static int swap_entry_get_devno(SwapEntry *swap) {
+        _cleanup_close_ int fd = -EBADF;
+        struct stat st;
+        int r;
+
+        assert(swap);
+
+        fd = swap_entry_open(swap, &st);
+        if (fd < 0)
+                return fd;
+
         if (!swap->swapfile) {
                 if (!S_ISBLK(st.st_mode))
                         return -ENOTBLK;
 
                 swap->devno = st.st_rdev;
-                swap->offset = 0;
                 return 0;
         }
 
@@ -233,6 +244,33 @@ static int swap_entry_get_resume_config(SwapEntry *swap) {
         if (r == 0)
                 return -EMEDIUMTYPE;
 
+        return 0;
+}
+
+static int swap_entry_get_offset(SwapEntry *swap) {
+        _cleanup_close_ int fd = -EBADF;
+        uint64_t offset_raw;
+        struct stat st;
+        int r;
+
+        assert(swap);
+
+        /* Determining the offset of a swap file requires mapping its extents, hence this is only done for
+         * the entries where it is actually needed, not for all of them. */
+
+        if (!swap->swapfile) {
+                swap->offset = 0;
+                return 0;
+        }
+
+        fd = swap_entry_open(swap, &st);
+        if (fd < 0)
+                return fd;
+
+        r = stat_verify_regular(&st);
+        if (r < 0)
+                return r;
+
         r = fd_is_fs_type(fd, BTRFS_SUPER_MAGIC);
         if (r < 0)
                 return log_debug_errno(r, "Failed to check if swap file '%s' is on Btrfs: %m", swap->path);
@@ -356,7 +394,7 @@ int find_suitable_hibernation_device_full(HibernationDevice *ret_device, uint64_
                 return r;
 
         FOREACH_ARRAY(swap, entries.swaps, entries.n_swaps) {
-                r = swap_entry_get_resume_config(swap);
+                r = swap_entry_get_devno(swap);
                 if (r == -EMEDIUMTYPE) {
                         assert(swap->swapfile);
 
@@ -369,15 +407,21 @@ int find_suitable_hibernation_device_full(HibernationDevice *ret_device, uint64_
                 assert(swap->devno > 0);
 
                 if (resume_config_devno > 0) {
-                        if (swap->devno == resume_config_devno &&
-                            (!swap->swapfile || swap->offset == resume_config_offset)) {
+                        if (swap->devno != resume_config_devno)
+                                /* If resume= is set, don't try to use other swap spaces. */
+                                continue;
+
+                        r = swap_entry_get_offset(swap);
+                        if (r < 0)
+                                return log_debug_errno(r, "Failed to get offset for swap '%s': %m", swap->path);
+
+                        if (!swap->swapfile || swap->offset == resume_config_offset) {
                                 /* /sys/power/resume (resume=) is set, and the calculated swap file offset
                                  * matches with /sys/power/resume_offset. */
                                 entry = swap;
                                 break;
                         }
 
-                        /* If resume= is set, don't try to use other swap spaces. */
                         continue;
                 }
 
@@ -394,6 +438,14 @@ int find_suitable_hibernation_device_full(HibernationDevice *ret_device, uint64_
                 return log_debug_errno(SYNTHETIC_ERRNO(ENOSPC), "No swap space available for hibernation.");
         }
 
+        if (resume_config_devno == 0) {
+                /* Also when the caller isn't interested in the device: a swap file whose offset cannot be
+                 * determined cannot be resumed from, and hence must not be reported as suitable. */
+                r = swap_entry_get_offset(entry);
+                if (r < 0)
+                        return log_debug_errno(r, "Failed to get offset for swap '%s': %m", entry->path);
+        }
+
         if (ret_device) {
                 char *path;
 
@@ -10,6 +10,7 @@
 #include "format-util.h"
 #include "journal-authenticate.h"
 #include "journal-file-util.h"
+#include "memory-util.h"
 #include "path-util.h"
 #include "random-util.h"
 #include "set.h"
@@ -91,8 +92,144 @@ static int journal_file_entry_array_punch_hole(JournalFile *f, uint64_t p, uint6
         return 0;
 }
 
+static int punch_hole(JournalFile *f, uint64_t offset, uint64_t sz) {
+        assert(f);
+
+        if (fallocate(f->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, sz) < 0) {
+                if (ERRNO_IS_NOT_SUPPORTED(errno))
+                        return log_debug_errno(SYNTHETIC_ERRNO(EOPNOTSUPP), /* Make recognizable */
+                                               "Hole punching not supported by backing file system, skipping.");
+
+                return log_debug_errno(errno, "Failed to punch hole in hash table of %s: %m", f->path);
+        }
+
+        return 0;
+}
+
+/* The hash tables are sized for the maximum size of the file, hence files that are archived early (e.g.
+ * because of a reboot or a time based rotation) usually have large stretches of empty buckets. An empty
+ * bucket is all zeroes, just like a hole, so those pages may be released to the file system without
+ * changing what readers see. Unlike with the other holes we punch, the empty stretches are scattered all
+ * over the table, hence the table contents are fed in page by page, in order, as they are read anyway. */
+typedef struct HashTableHoles {
+        uint64_t start, end;        /* The page aligned part of the table that may be released */
+        uint64_t page;              /* The page currently being looked at, UINT64_MAX if none */
+        bool page_is_zero;
+        uint64_t hole, hole_end;    /* The current run of empty pages, hole is UINT64_MAX if none */
+        bool failed;
+} HashTableHoles;
+
+static void hash_table_holes_init(HashTableHoles *h, uint64_t offset, uint64_t size) {
+        assert(h);
+
+        *h = (HashTableHoles) {
+                .start = PAGE_ALIGN_U64(offset),
+                .end = PAGE_ALIGN_DOWN_U64(offset + size),
+                .page = UINT64_MAX,
+                .hole = UINT64_MAX,
+        };
+}
+
+static int hash_table_holes_flush(JournalFile *f, HashTableHoles *h) {
+        int r;
+
+        assert(f);
+        assert(h);
+
+        if (h->hole == UINT64_MAX)
+                return 0;
+
+        r = punch_hole(f, h->hole, h->hole_end - h->hole);
+        h->hole = UINT64_MAX;
+        if (r < 0) {
+                h->failed = true;
+                return r;
+        }
+
+        return 0;
+}
+
+static int hash_table_holes_feed(JournalFile *f, HashTableHoles *h, uint64_t offset, const void *data, size_t n) {
+        size_t ps = page_size();
+        int r;
+
+        assert(f);
+        assert(h);
+        assert(data || n == 0);
+
+        if (h->failed)
+                return 0;
+
+        for (uint64_t q = offset, next; q < offset + n; q = next) {
+                uint64_t page = PAGE_ALIGN_DOWN_U64(q);
+
+                next = MIN(page + ps, offset + n);
+
+                /* Pages only partially covered by the table also contain other objects */
+                if (page < h->start || page >= h->end)
+                        continue;
+
+                if (page != h->page) {
+                        h->page = page;
+                        h->page_is_zero = true;
+                }
+
+                if (h->page_is_zero)
+                        h->page_is_zero = memeqzero((const uint8_t*) data + (q - offset), next - q);
+
+                if (next < page + ps)
+                        continue; /* The rest of the page comes with the next chunk */
+
+                if (h->page_is_zero) {
+                        if (h->hole == UINT64_MAX)
+                                h->hole = page;
+                        h->hole_end = page + ps;
+                        continue;
+                }
+
+                r = hash_table_holes_flush(f, h);
+                if (r < 0)
+                        return r;
+        }
+
+        return 0;
+}
+
+static int hash_table_holes_finish(JournalFile *f, HashTableHoles *h) {
+        assert(h);
+
+        if (h->failed)
+                return 0;
+
+        return hash_table_holes_flush(f, h);
+}
+
+static int journal_file_hash_table_punch_holes(JournalFile *f, uint64_t offset, uint64_t size) {
+        uint8_t buf[PAYLOAD_BUFFER_SIZE];
+        HashTableHoles h;
+        ssize_t n = SSIZE_MAX;
+        int r;
+
+        assert(f);
+
+        hash_table_holes_init(&h, offset, size);
+
+        for (uint64_t i = offset; i < offset + size && n > 0; i += n) {
+                n = pread(f->fd, buf, MIN(sizeof(buf), offset + size - i), i);
+                if (n < 0)
+                        return log_debug_errno(errno, "Failed to read hash table items: %m");
+
+                r = hash_table_holes_feed(f, &h, i, buf, n);
+                if (r < 0)
+                        return r;
+        }
+
+        return hash_table_holes_finish(f, &h);
+}
+
 static int journal_file_punch_holes(JournalFile *f) {
         HashItem items[PAYLOAD_BUFFER_SIZE / sizeof(HashItem)];
+        HashTableHoles holes;
         uint64_t p, sz;
         ssize_t n = SSIZE_MAX;
         int r;
@@ -105,6 +242,9 @@ static int journal_file_punch_holes(JournalFile *f) {
         p = le64toh(f->header->data_hash_table_offset);
         sz = le64toh(f->header->data_hash_table_size);
 
+        /* Empty buckets of the data hash table are collected while walking it anyway */
+        hash_table_holes_init(&holes, p, sz);
+
         for (uint64_t i = p; i < p + sz && n > 0; i += n) {
                 size_t m = MIN(sizeof(items), p + sz - i);
                 n = pread(f->fd, items, m, i);
@@ -114,6 +254,12 @@ static int journal_file_punch_holes(JournalFile *f) {
                 /* Let's ignore any partial hash items by rounding down to the nearest multiple of HashItem. */
                 n -= n % sizeof(HashItem);
 
+                r = hash_table_holes_feed(f, &holes, i, items, n);
+                if (r == -EOPNOTSUPP)
+                        return r;
+
+                /* Ignore other errors */
+
                 for (size_t j = 0; j < (size_t) n / sizeof(HashItem); j++) {
                         Object o;
 
@@ -139,6 +285,15 @@ static int journal_file_punch_holes(JournalFile *f) {
                 }
         }
 
+        r = hash_table_holes_finish(f, &holes);
+        if (r == -EOPNOTSUPP)
+                return r;
+
+        (void) journal_file_hash_table_punch_holes(
+                        f,
+                        le64toh(f->header->field_hash_table_offset),
+                        le64toh(f->header->field_hash_table_size));
+
         return 0;
 }
 
@@ -30,6 +30,7 @@
 #include "output-mode.h"
 #include "parse-util.h"
 #include "pretty-print.h"
+#include "sort-util.h"
 #include "sparse-endian.h"
 #include "stdio-util.h"
 #include "string-table.h"
@@ -1170,6 +1171,312 @@ static int update_json_data_split(
         return update_json_data(h, flags, name, eq + 1, size - fieldlen - 1);
 }
 
+static int get_json_header(
+                sd_journal *j,
+                char **ret_cursor,
+                usec_t *ret_realtime,
+                usec_t *ret_monotonic,
+                sd_id128_t *ret_boot_id,
+                uint64_t *ret_seqnum,
+                sd_id128_t *ret_seqnum_id) {
+
+        int r;
+
+        assert(j);
+
+        r = sd_journal_get_cursor(j, ret_cursor);
+        if (r < 0)
+                return log_error_errno(r, "Failed to get cursor: %m");
+
+        r = sd_journal_get_realtime_usec(j, ret_realtime);
+        if (r < 0)
+                return log_error_errno(r, "Failed to get realtime timestamp: %m");
+
+        r = sd_journal_get_monotonic_usec(j, ret_monotonic, ret_boot_id);
+        if (r < 0)
+                return log_error_errno(r, "Failed to get monotonic timestamp: %m");
+
+        r = sd_journal_get_seqnum(j, ret_seqnum, ret_seqnum_id);
+        if (r < 0)
+                return log_error_errno(r, "Failed to get seqnum: %m");
+
+        return 0;
+}
+
+/* The compact JSON output modes are generated directly from the data the journal returns, without building
+ * a JSON variant for each field first. Each field is encoded into one buffer, and once all fields of the entry
+ * are known, fields with the same name are grouped into arrays and the object is written out in one go. */
+
+typedef struct JsonField {
+        size_t index;
+        size_t name_offset;
+        size_t name_size;
+        size_t value_offset;
+        size_t value_size;
+} JsonField;
+
+typedef struct JsonBuffer {
+        char *data;
+        size_t size;
+        JsonField *fields;
+        size_t n_fields;
+} JsonBuffer;
+
+static void json_buffer_done(JsonBuffer *b) {
+        assert(b);
+
+        b->data = mfree(b->data);
+        b->fields = mfree(b->fields);
+}
+
+static char* json_encode_string(char *p, const char *s, size_t l) {
+        assert(p);
+        assert(s || l == 0);
+
+        /* Same escaping as sd_json_variant_dump() uses */
+
+        *(p++) = '"';
+
+        for (const char *e = s + l; s < e; s++)
+                switch (*s) {
+                case '"':
+                case '\\':
+                        *(p++) = '\\';
+                        *(p++) = *s;
+                        break;
+                case '\b':
+                        p = mempcpy(p, "\\b", 2);
+                        break;
+                case '\f':
+                        p = mempcpy(p, "\\f", 2);
+                        break;
+                case '\n':
+                        p = mempcpy(p, "\\n", 2);
+                        break;
+                case '\r':
+                        p = mempcpy(p, "\\r", 2);
+                        break;
+                case '\t':
+                        p = mempcpy(p, "\\t", 2);
+                        break;
+                default:
+                        if ((signed char) *s >= 0 && *s < ' ')
+                                p += sprintf(p, "\\u%04x", (unsigned) *s);
+                        else
+                                *(p++) = *s;
+                }
+
+        *(p++) = '"';
+
+        return p;
+}
+
+static int json_buffer_add(
+                JsonBuffer *b,
+                OutputFlags flags,
+                const char *name,
+                size_t name_size,
+                const void *value,
+                size_t size) {
+
+        size_t name_offset, value_offset;
+        char *p;
+
+        assert(b);
+        assert(name);
+        assert(value || size == 0);
+
+        if (size == SIZE_MAX)
+                size = strlen(value);
+
+        if (!GREEDY_REALLOC(b->fields, b->n_fields + 1))
+                return log_oom();
+
+        /* Reserve enough space for the name, and the value in the worst case: six characters per byte when
+         * escaped in a string, four when formatted as array of bytes. */
+        if (size > (SIZE_MAX - name_size - b->size - 2) / 6 ||
+            !GREEDY_REALLOC(b->data, b->size + name_size + size * 6 + 2))
+                return log_oom();
+
+        name_offset = b->size;
+        p = mempcpy(b->data + name_offset, name, name_size);
+        value_offset = p - b->data;
+
+        if (!(flags & OUTPUT_SHOW_ALL) && name_size + 1 + size >= JSON_THRESHOLD)
+                p = mempcpy(p, "null", 4);
+        else if (utf8_is_printable(value, size))
+                p = json_encode_string(p, value, size);
+        else {
+                *(p++) = '[';
+                for (size_t i = 0; i < size; i++) {
+                        if (i > 0)
+                                *(p++) = ',';
+                        p += sprintf(p, "%u", ((const uint8_t*) value)[i]);
+                }
+                *(p++) = ']';
+        }
+
+        b->fields[b->n_fields] = (JsonField) {
+                .index = b->n_fields,
+                .name_offset = name_offset,
+                .name_size = name_size,
+                .value_offset = value_offset,
+                .value_size = p - b->data - value_offset,
+        };
+        b->n_fields++;
+        b->size = p - b->data;
+
+        return 0;
+}
+
+static int json_field_compare(const JsonField *x, const JsonField *y, char *data) {
+        int r;
+
+        r = memcmp_nn(data + x->name_offset, x->name_size, data + y->name_offset, y->name_size);
+        if (r != 0)
+                return r;
+
+        return CMP(x->index, y->index);
+}
+
+static void json_buffer_write(JsonBuffer *b, FILE *f, OutputMode mode) {
+        assert(b);
+        assert(f);
+
+        typesafe_qsort_r(b->fields, b->n_fields, json_field_compare, b->data);
+
+        if (mode == OUTPUT_JSON_SSE)
+                fputs("data: ", f);
+        if (mode == OUTPUT_JSON_SEQ)
+                fputc('\x1e', f); /* ASCII Record Separator */
+
+        fputc('{', f);
+
+        for (size_t i = 0, n; i < b->n_fields; i += n) {
+                const JsonField *field = b->fields + i;
+
+                /* Field names are validated, hence need no escaping */
+                if (i > 0)
+                        fputc(',', f);
+                fputc('"', f);
+                fwrite(b->data + field->name_offset, 1, field->name_size, f);
+                fputs("\":", f);
+
+                for (n = 1; i + n < b->n_fields; n++)
+                        if (memcmp_nn(b->data + field->name_offset, field->name_size,
+                                      b->data + field[n].name_offset, field[n].name_size) != 0)
+                                break;
+
+                if (n > 1)
+                        fputc('[', f);
+
+                for (size_t k = 0; k < n; k++) {
+                        if (k > 0)
+                                fputc(',', f);
+                        fwrite(b->data + field[k].value_offset, 1, field[k].value_size, f);
+                }
+
+                if (n > 1)
+                        fputc(']', f);
+        }
+
+        fputs("}\n", f);
+        if (mode == OUTPUT_JSON_SSE)
+                fputc('\n', f); /* In case of SSE add a second newline */
+}
+
+static int output_json_direct(
+                FILE *f,
+                sd_journal *j,
+                OutputMode mode,
+                OutputFlags flags,
+                const Set *output_fields) {
+
+        char usecbuf[CONST_MAX(DECIMAL_STR_MAX(usec_t), DECIMAL_STR_MAX(uint64_t))];
+        _cleanup_(json_buffer_done) JsonBuffer b = {};
+        sd_id128_t journal_boot_id, seqnum_id;
+        _cleanup_free_ char *cursor = NULL;
+        usec_t realtime, monotonic;
+        uint64_t seqnum;
+        int r;
+
+        assert(f);
+        assert(j);
+
+        (void) sd_journal_set_data_threshold(j, flags & OUTPUT_SHOW_ALL ? 0 : JSON_THRESHOLD);
+
+        r = get_json_header(j, &cursor, &realtime, &monotonic, &journal_boot_id, &seqnum, &seqnum_id);
+        if (r < 0)
+                return r;
+
+        r = json_buffer_add(&b, flags, "__CURSOR", STRLEN("__CURSOR"), cursor, SIZE_MAX);
+        if (r < 0)
+                return r;
+
+        xsprintf(usecbuf, USEC_FMT, realtime);
+        r = json_buffer_add(&b, flags, "__REALTIME_TIMESTAMP", STRLEN("__REALTIME_TIMESTAMP"), usecbuf, SIZE_MAX);
+        if (r < 0)
+                return r;
+
+        xsprintf(usecbuf, USEC_FMT, monotonic);
+        r = json_buffer_add(&b, flags, "__MONOTONIC_TIMESTAMP", STRLEN("__MONOTONIC_TIMESTAMP"), usecbuf, SIZE_MAX);
+        if (r < 0)
+                return r;
+
+        r = json_buffer_add(&b, flags, "_BOOT_ID", STRLEN("_BOOT_ID"), SD_ID128_TO_STRING(journal_boot_id), SIZE_MAX);
+        if (r < 0)
+                return r;
+
+        xsprintf(usecbuf, USEC_FMT, seqnum);
+        r = json_buffer_add(&b, flags, "__SEQNUM", STRLEN("__SEQNUM"), usecbuf, SIZE_MAX);
+        if (r < 0)
+                return r;
+
+        r = json_buffer_add(&b, flags, "__SEQNUM_ID", STRLEN("__SEQNUM_ID"), SD_ID128_TO_STRING(seqnum_id), SIZE_MAX);
+        if (r < 0)
+                return r;
+
+        for (;;) {
+                const void *data;
+                size_t size, fieldlen;
+                const char *eq;
+
+                r = sd_journal_enumerate_data(j, &data, &size);
+                if (IN_SET(r, -EBADMSG, -EADDRNOTAVAIL)) {
+                        log_debug_errno(r, "Skipping message we can't read: %m");
+                        return 0;
+                }
+                if (r < 0)
+                        return log_error_errno(r, "Failed to read journal: %m");
+                if (r == 0)
+                        break;
+
+                if (memory_startswith(data, size, "_BOOT_ID="))
+                        continue;
+
+                eq = memchr(data, '=', MIN(size, JSON_THRESHOLD));
+                if (!eq)
+                        continue;
+
+                fieldlen = eq - (const char*) data;
+                if (!journal_field_valid(data, fieldlen, true))
+                        return log_error_errno(SYNTHETIC_ERRNO(EINVAL), "Invalid field.");
+
+                r = field_set_test(output_fields, data, fieldlen);
+                if (r < 0)
+                        return r;
+                if (!r)
+                        continue;
+
+                r = json_buffer_add(&b, flags, data, fieldlen, eq + 1, size - fieldlen - 1);
+                if (r < 0)
+                        return r;
+        }
+
+        json_buffer_write(&b, f, mode);
+        return 0;
+}
+
 static int output_json(
                 FILE *f,
                 sd_journal *j,
@@ -1195,23 +1502,14 @@ static int output_json(
 
         assert(j);
 
-        (void) sd_journal_set_data_threshold(j, flags & OUTPUT_SHOW_ALL ? 0 : JSON_THRESHOLD);
-
-        r = sd_journal_get_cursor(j, &cursor);
-        if (r < 0)
-                return log_error_errno(r, "Failed to get cursor: %m");
-
-        r = sd_journal_get_realtime_usec(j, &realtime);
-        if (r < 0)
-                return log_error_errno(r, "Failed to get realtime timestamp: %m");
+        if (mode != OUTPUT_JSON_PRETTY && !FLAGS_SET(flags, OUTPUT_COLOR))
+                return output_json_direct(f, j, mode, flags, output_fields);
 
-        r = sd_journal_get_monotonic_usec(j, &monotonic, &journal_boot_id);
-        if (r < 0)
-                return log_error_errno(r, "Failed to get monotonic timestamp: %m");
+        (void) sd_journal_set_data_threshold(j, flags & OUTPUT_SHOW_ALL ? 0 : JSON_THRESHOLD);
 
-        r = sd_journal_get_seqnum(j, &seqnum, &seqnum_id);
+        r = get_json_header(j, &cursor, &realtime, &monotonic, &journal_boot_id, &seqnum, &seqnum_id);
         if (r < 0)
-                return log_error_errno(r, "Failed to get seqnum: %m");
+                return r;
 
         h = hashmap_new(&json_data_hash_ops_free);
         if (!h)
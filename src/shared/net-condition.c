@@ -136,11 +136,8 @@ int net_match_config(
 
         assert(match);
 
-        if (net_get_type_string(device, iftype, &iftype_str) == -ENOMEM)
-                return -ENOMEM;
-
-        if (device)
-                (void) sd_device_get_property_value(device, "ID_PATH", &path);
+        /* This is called for each pair of interface and .network or .link file, hence cheap checks go
+         * first, and the ID_PATH property and the type string are only looked up when they are needed. */
 
         if (match->hw_addr && (!hw_addr || !set_contains(match->hw_addr, hw_addr)))
                 return false;
@@ -150,14 +147,24 @@ int net_match_config(
              !set_contains(match->permanent_hw_addr, permanent_hw_addr)))
                 return false;
 
-        if (!net_condition_test_strv(match->path, path))
-                return false;
-
         if (!net_condition_test_strv(match->driver, driver))
                 return false;
 
-        if (!net_condition_test_strv(match->iftype, iftype_str))
-                return false;
+        if (!strv_isempty(match->path)) {
+                if (device)
+                        (void) sd_device_get_property_value(device, "ID_PATH", &path);
+
+                if (!net_condition_test_strv(match->path, path))
+                        return false;
+        }
+
+        if (!strv_isempty(match->iftype)) {
+                if (net_get_type_string(device, iftype, &iftype_str) == -ENOMEM)
+                        return -ENOMEM;
+
+                if (!net_condition_test_strv(match->iftype, iftype_str))
+                        return false;
+        }
 
         if (!net_condition_test_strv(match->kind, kind))
                 return false;
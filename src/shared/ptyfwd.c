@@ -46,6 +46,12 @@ typedef enum AnsiColorState  {
 
 assert_cc(ANSI_SEQUENCE_LENGTH_MAX > ANSI_SEQUENCE_WINDOW_TITLE_MAX);
 
+/* The output buffer starts out at LINE_MAX, and is grown up to this size if output arrives faster than it
+ * can be written out, so that bulk output is forwarded in large chunks. */
+#define OUT_BUFFER_SIZE_MAX (64U * 1024U)
+
+assert_cc(OUT_BUFFER_SIZE_MAX > LINE_MAX);
+
 /* We don't list SIGHUP here because that's what you get when your tty has a hangup, and if we do we'll close
  * the pty too which already generates a hangup, and thus a SIGHUP, which means we'd generate SIGHUP twice,
  * once by us, and once by the kernel. */
@@ -308,7 +314,7 @@ static int insert_string(PTYForward *f, size_t offset, const char *s) {
         size_t l = strlen(s);
         assert(l <= INT_MAX); /* Make sure we can still return this */
 
-        void *p = realloc(f->out_buffer, MAX(f->out_buffer_full + l, (size_t) LINE_MAX));
+        void *p = realloc(f->out_buffer, MAX3(f->out_buffer_full + l, f->out_buffer_size, (size_t) LINE_MAX));
         if (!p)
                 return -ENOMEM;
 
@@ -718,7 +724,19 @@ static int do_shovel(PTYForward *f) {
                         did_something = true;
                 }
 
-                if (f->master_readable && f->out_buffer_full < MIN(f->out_buffer_size, (size_t) LINE_MAX)) {
+                if (f->master_readable && f->out_buffer_full < OUT_BUFFER_SIZE_MAX) {
+
+                        if (f->out_buffer_size - f->out_buffer_full < LINE_MAX &&
+                            f->out_buffer_size < OUT_BUFFER_SIZE_MAX) {
+                                /* Less than a line of room left, because we read faster than we can
+                                 * write out. Grow the buffer, so that more is written per write(). */
+                                void *p = realloc(f->out_buffer, MIN(f->out_buffer_size * 2, (size_t) OUT_BUFFER_SIZE_MAX));
+                                if (!p)
+                                        return log_oom();
+
+                                f->out_buffer = p;
+                                f->out_buffer_size = MALLOC_SIZEOF_SAFE(p);
+                        }
 
                         k = read(f->master, f->out_buffer + f->out_buffer_full, f->out_buffer_size - f->out_buffer_full);
                         if (k < 0) {
@@ -749,7 +767,10 @@ static int do_shovel(PTYForward *f) {
                         did_something = true;
                 }
 
-                if (f->stdout_writable && f->out_buffer_write_len > 0) {
+                /* Coalesce writes: as long as there's more to read from the master, and there's room left
+                 * in the buffer, read that first. */
+                if (f->stdout_writable && f->out_buffer_write_len > 0 &&
+                    (!f->master_readable || f->out_buffer_full >= OUT_BUFFER_SIZE_MAX)) {
                         assert(f->out_buffer_write_len <= f->out_buffer_full);
 
                         k = write(f->output_fd, f->out_buffer, f->out_buffer_write_len);
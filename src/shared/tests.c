@@ -324,6 +324,23 @@ int enter_cgroup_root(char **ret_cgroup) {
         return enter_cgroup(ret_cgroup, false);
 }
 
+uint64_t test_random_u64(uint64_t *state) {
+        assert(state);
+        assert(*state != 0);
+
+        *state ^= *state >> 12;
+        *state ^= *state << 25;
+        *state ^= *state >> 27;
+        return *state * UINT64_C(2685821657736338717);
+}
+
+unsigned test_random_skewed(uint64_t *state, unsigned n) {
+        /* Cubing a uniformly distributed value in [0, 1) skews the result towards 0, similar to real
+         * systems, where a few entities (services, units, …) account for most of the activity. */
+        double x = (double) (test_random_u64(state) >> 11) / (double) (UINT64_C(1) << 53);
+        return (unsigned) (x * x * x * n);
+}
+
 const char* ci_environment(void) {
         /* We return a string because we might want to provide multiple bits of information later on: not
          * just the general CI environment type, but also whether we're sanitizing or not, etc. The caller is
@@ -82,6 +82,12 @@ bool userns_has_single_user(void);
 #define CAN_MEMLOCK_SIZE (512 * 1024U)
 bool can_memlock(void);
 
+/* A deterministic pseudo-random number generator (xorshift64*), for tests and benchmarks that need the
+ * same input on every run, hence cannot use random_u64(). The state must be initialized to non-zero. */
+uint64_t test_random_u64(uint64_t *state);
+/* Picks a value in [0, n), with small values being much more likely */
+unsigned test_random_skewed(uint64_t *state, unsigned n);
+
 /* Define void* buffer and size_t length variables from a hex string. */
 #define DEFINE_HEX_PTR(name, hex)                                       \
         _cleanup_free_ void *name = NULL;                               \
@@ -7,6 +7,24 @@ static SD_VARLINK_DEFINE_METHOD(Rotate);
 static SD_VARLINK_DEFINE_METHOD(FlushToVar);
 static SD_VARLINK_DEFINE_METHOD(RelinquishVar);
 
+static SD_VARLINK_DEFINE_STRUCT_TYPE(
+                RateLimitGroup,
+                SD_VARLINK_FIELD_COMMENT("The unit the rate limit applies to"),
+                SD_VARLINK_DEFINE_FIELD(unit, SD_VARLINK_STRING, 0),
+                SD_VARLINK_FIELD_COMMENT("The rate limit interval in µs"),
+                SD_VARLINK_DEFINE_FIELD(intervalUSec, SD_VARLINK_INT, 0),
+                SD_VARLINK_FIELD_COMMENT("Number of messages suppressed in the current rate limit intervals, that have not been reported yet"),
+                SD_VARLINK_DEFINE_FIELD(suppressed, SD_VARLINK_INT, 0),
+                SD_VARLINK_FIELD_COMMENT("Number of messages suppressed since the unit started being tracked"),
+                SD_VARLINK_DEFINE_FIELD(suppressedTotal, SD_VARLINK_INT, 0));
+
+static SD_VARLINK_DEFINE_METHOD(
+                DescribeRateLimits,
+                SD_VARLINK_FIELD_COMMENT("Number of messages suppressed by rate limiting since the service started"),
+                SD_VARLINK_DEFINE_OUTPUT(suppressedTotal, SD_VARLINK_INT, 0),
+                SD_VARLINK_FIELD_COMMENT("Currently tracked rate limit groups, least recently active first"),
+                SD_VARLINK_DEFINE_OUTPUT_BY_TYPE(groups, RateLimitGroup, SD_VARLINK_ARRAY));
+
 static SD_VARLINK_DEFINE_ERROR(NotSupportedByNamespaces);
 
 SD_VARLINK_DEFINE_INTERFACE(
@@ -21,5 +39,9 @@ SD_VARLINK_DEFINE_INTERFACE(
                 &vl_method_FlushToVar,
                 SD_VARLINK_SYMBOL_COMMENT("Relinquish use of /var/ again, return to do runtime logging into /run/ only."),
                 &vl_method_RelinquishVar,
+                SD_VARLINK_SYMBOL_COMMENT("A rate limit group, i.e. a unit whose log messages are subject to rate limiting."),
+                &vl_type_RateLimitGroup,
+                SD_VARLINK_SYMBOL_COMMENT("Report per-unit rate limiting state and the number of suppressed log messages."),
+                &vl_method_DescribeRateLimits,
                 SD_VARLINK_SYMBOL_COMMENT("Journal service running as per-namespace instance, and requested operation is not supported for namespaced journal."),
                 &vl_error_NotSupportedByNamespaces);
@@ -549,6 +549,56 @@ TEST_RET(copy_holes_with_gaps) {
         return 0;
 }
 
+TEST_RET(copy_sparse) {
+        _cleanup_(rm_rf_physical_and_freep) char *t = NULL;
+        _cleanup_close_pair_ int pfd[2] = EBADF_PAIR;
+        _cleanup_close_ int tfd = -EBADF, fd_copy = -EBADF;
+        _cleanup_free_ char *buf = NULL, *copy = NULL;
+        struct stat st;
+        off_t blksz;
+        size_t size;
+        int r;
+
+        assert_se((tfd = mkdtemp_open(NULL, 0, &t)) >= 0);
+        assert_se((fd_copy = openat(tfd, "dst", O_CREAT | O_RDWR, 0600)) >= 0);
+
+        r = RET_NERRNO(fallocate(fd_copy, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, 1));
+        if (ERRNO_IS_NOT_SUPPORTED(r))
+                return log_tests_skipped("Filesystem doesn't support hole punching");
+
+        ASSERT_OK_ERRNO(fstat(fd_copy, &st));
+        blksz = st.st_blksize;
+
+        /* Feed data block, 2 blocks of NUL bytes, data block, 1 block of NUL bytes through a pipe, which
+         * can't report holes to us, and check that the NUL blocks end up as holes in the copy. The first
+         * data block contains a shorter run of NUL bytes, which must be written out as data. */
+        assert_se(buf = new0(char, 5 * blksz));
+        memset(buf, 1, blksz);
+        memset(buf + 16, 0, blksz / 2);
+        memset(buf + 3 * blksz, 1, blksz);
+
+        ASSERT_OK_ERRNO(pipe2(pfd, O_CLOEXEC));
+        if (5 * blksz > fcntl(pfd[1], F_GETPIPE_SZ))
+                ASSERT_OK_ERRNO(fcntl(pfd[1], F_SETPIPE_SZ, 5 * blksz));
+        ASSERT_OK(loop_write(pfd[1], buf, 5 * blksz));
+        pfd[1] = safe_close(pfd[1]);
+
+        ASSERT_OK_ZERO(copy_bytes(pfd[0], fd_copy, UINT64_MAX, COPY_SPARSE));
+
+        ASSERT_OK_ERRNO(fstat(fd_copy, &st));
+        ASSERT_EQ(st.st_size, 5 * blksz);
+
+        ASSERT_EQ(lseek(fd_copy, 0, SEEK_HOLE), blksz);
+        ASSERT_EQ(lseek(fd_copy, blksz, SEEK_DATA), 3 * blksz);
+        ASSERT_EQ(lseek(fd_copy, 3 * blksz, SEEK_HOLE), 4 * blksz);
+
+        ASSERT_OK(read_full_file_at(tfd, "dst", &copy, &size));
+        ASSERT_EQ(size, (size_t) (5 * blksz));
+        ASSERT_EQ(memcmp(buf, copy, size), 0);
+
+        return 0;
+}
+
 TEST(copy_lock) {
         _cleanup_(rm_rf_physical_and_freep) char *t = NULL;
         _cleanup_close_ int tfd = -EBADF, fd = -EBADF;
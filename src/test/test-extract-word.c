@@ -590,6 +590,15 @@ TEST(extract_first_word) {
         ASSERT_OK_POSITIVE(extract_first_word(&p, &t, NULL, EXTRACT_UNQUOTE | EXTRACT_CUNESCAPE));
         ASSERT_STREQ(t, "test4@/pure/path/like/data.service");
         free(t);
+
+        /* Words longer than the initial allocation, mixing plain runs with quotes and escapes */
+        p = "/usr/lib/systemd/some-very-long-executable-name-which-does-not-fit-into-the-initial-buffer"
+            "\\x20and\\x20\"a quoted part\"trailing-and-again-a-longer-run-of-plain-characters a";
+        ASSERT_OK_POSITIVE(extract_first_word(&p, &t, NULL, EXTRACT_UNQUOTE | EXTRACT_CUNESCAPE));
+        ASSERT_STREQ(t, "/usr/lib/systemd/some-very-long-executable-name-which-does-not-fit-into-the-initial-buffer"
+                     " and a quoted parttrailing-and-again-a-longer-run-of-plain-characters");
+        free(t);
+        ASSERT_STREQ(p, "a");
 }
 
 TEST(extract_first_word_and_warn) {
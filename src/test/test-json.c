@@ -751,6 +751,8 @@ TEST(tokenizer) {
         test_tokenizer_one("\"\\ud800a\"", -EINVAL);
         test_tokenizer_one("\"\\udc00\\udc00\"", -EINVAL);
         test_tokenizer_one("\"\\ud801\\udc37\"", JSON_TOKEN_STRING, "\xf0\x90\x90\xb7", JSON_TOKEN_END);
+        test_tokenizer_one("\"\\uffff\"", -EUCLEAN);
+        test_tokenizer_one("\"\\ud83f\\udffe\"", -EUCLEAN);
 
         test_tokenizer_one("[1, 2, -3]", JSON_TOKEN_ARRAY_OPEN, JSON_TOKEN_UNSIGNED, (uint64_t) 1, JSON_TOKEN_COMMA, JSON_TOKEN_UNSIGNED, (uint64_t) 2, JSON_TOKEN_COMMA, JSON_TOKEN_INTEGER, (int64_t) -3, JSON_TOKEN_ARRAY_CLOSE, JSON_TOKEN_END);
 }
@@ -1140,6 +1142,22 @@ TEST(json_sensitive) {
         ASSERT_STREQ(s, "{\"b\":[\"foo\",\"bar\",\"baz\",\"qux\"],\"c\":-9223372036854775808,\"d\":\"-9223372036854775808\",\"e\":{},\"a\":\"<sensitive data>\"}");
 }
 
+TEST(json_format_string_escape) {
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *v = NULL;
+        _cleanup_free_ char *s = NULL;
+
+        ASSERT_OK(sd_json_variant_new_string(&v, "plain \"quoted\" back\\slash\b\f\n\r\t\x01\x1f\x7f ü end"));
+        ASSERT_OK(sd_json_variant_format(v, 0, &s));
+        ASSERT_STREQ(s, "\"plain \\\"quoted\\\" back\\\\slash\\b\\f\\n\\r\\t\\u0001\\u001f\x7f ü end\"");
+
+        v = sd_json_variant_unref(v);
+        s = mfree(s);
+
+        ASSERT_OK(sd_json_variant_new_string(&v, ""));
+        ASSERT_OK(sd_json_variant_format(v, 0, &s));
+        ASSERT_STREQ(s, "\"\"");
+}
+
 TEST(json_iovec) {
         struct iovec iov1 = CONST_IOVEC_MAKE_STRING("üxknürz"), iov2 = CONST_IOVEC_MAKE_STRING("wuffwuffmiau");
 
@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "sd-journal.h"
+#include "sd-json.h"
+
+#include "alloc-util.h"
+#include "chattr-util.h"
+#include "iovec-util.h"
+#include "journal-file-util.h"
+#include "json-util.h"
+#include "logs-show.h"
+#include "memstream-util.h"
+#include "path-util.h"
+#include "rm-rf.h"
+#include "string-util.h"
+#include "strv.h"
+#include "tests.h"
+#include "tmpfile-util.h"
+
+static void append_entries(const char *directory) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        _cleanup_free_ char *path = NULL, *large = NULL;
+        dual_timestamp ts = {
+                .realtime = 1700000000 * USEC_PER_SEC,
+                .monotonic = USEC_PER_SEC,
+        };
+        JournalFile *f;
+
+        ASSERT_NOT_NULL(m = mmap_cache_new());
+        ASSERT_NOT_NULL(path = path_join(directory, "test.journal"));
+        ASSERT_OK(journal_file_open(-EBADF, path, O_RDWR|O_CREAT, JOURNAL_COMPRESS, 0644, UINT64_MAX, NULL, m, NULL, &f));
+
+        /* Larger than JSON_THRESHOLD, hence only shown with OUTPUT_SHOW_ALL */
+        ASSERT_NOT_NULL(large = strjoin("LARGE=", strrepa("x", 5000)));
+
+        const struct iovec escapes[] = {
+                IOVEC_MAKE_STRING("MESSAGE=quote \" backslash \\ tab \t newline \n slash / ünïcödé"),
+                IOVEC_MAKE_STRING("CONTROL=\b\f\r\x01\x1f"),
+                IOVEC_MAKE_STRING("EMPTY="),
+                IOVEC_MAKE_STRING("FO=prefix of FOO"),
+                IOVEC_MAKE_STRING("_PID=4711"),
+        }, binary[] = {
+                IOVEC_MAKE_STRING("MESSAGE=binary"),
+                IOVEC_MAKE("BINARY=\0\xff\x7f", STRLEN("BINARY=") + 3),
+                IOVEC_MAKE_STRING("INVALID_UTF8=\xc3\x28"),
+                IOVEC_MAKE_STRING(large),
+        }, multiple[] = {
+                IOVEC_MAKE_STRING("MESSAGE=multiple"),
+                IOVEC_MAKE_STRING("FOO=one"),
+                IOVEC_MAKE_STRING("ZZZ=last"),
+                IOVEC_MAKE_STRING("FOO=two \"quoted\""),
+                IOVEC_MAKE("FOO=\xfe", STRLEN("FOO=") + 1),
+                IOVEC_MAKE_STRING("AAA=first"),
+                IOVEC_MAKE_STRING("FOO=four"),
+        };
+
+        ASSERT_OK(journal_file_append_entry(f, &ts, NULL, escapes, ELEMENTSOF(escapes), NULL, NULL, NULL, NULL));
+        ts.realtime++;
+        ts.monotonic++;
+        ASSERT_OK(journal_file_append_entry(f, &ts, NULL, binary, ELEMENTSOF(binary), NULL, NULL, NULL, NULL));
+        ts.realtime++;
+        ts.monotonic++;
+        ASSERT_OK(journal_file_append_entry(f, &ts, NULL, multiple, ELEMENTSOF(multiple), NULL, NULL, NULL, NULL));
+
+        (void) journal_file_offline_close(f);
+}
+
+static void format_entry(sd_journal *j, OutputMode mode, OutputFlags flags, char **ret) {
+        _cleanup_(memstream_done) MemStream m = {};
+        dual_timestamp previous_display_ts = DUAL_TIMESTAMP_NULL;
+        sd_id128_t previous_boot_id = SD_ID128_NULL;
+        FILE *f;
+
+        /* The output functions enumerate the fields of the entry, hence start over for each of them */
+        sd_journal_restart_data(j);
+
+        ASSERT_NOT_NULL(f = memstream_init(&m));
+        ASSERT_OK(show_journal_entry(f, j, mode, /* n_columns= */ 0, flags, /* output_fields= */ NULL,
+                                     /* highlight= */ NULL, /* ellipsized= */ NULL,
+                                     &previous_display_ts, &previous_boot_id));
+        ASSERT_OK(memstream_finalize(&m, ret, NULL));
+}
+
+static void test_json_direct_one(sd_journal *j, OutputMode mode, OutputFlags flags) {
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *v = NULL, *sorted = NULL;
+        _cleanup_strv_free_ char **keys = NULL;
+        _cleanup_(memstream_done) MemStream m = {};
+        _cleanup_free_ char *direct = NULL, *pretty = NULL, *expected = NULL;
+        sd_json_variant *e;
+        const char *k;
+        FILE *f;
+
+        /* The compact modes are written out directly, while json-pretty still goes through sd-json. Format
+         * the latter again in the requested mode, with the fields sorted by name as the direct path does, and
+         * we must get the very same bytes. */
+
+        format_entry(j, mode, flags, &direct);
+        format_entry(j, OUTPUT_JSON_PRETTY, flags, &pretty);
+
+        ASSERT_OK(sd_json_parse(pretty, /* flags= */ 0, &v, NULL, NULL));
+
+        /* Not sd_json_variant_normalize(), as that would also reorder the values of fields that appear
+         * more than once, which are kept in the order of the entry. */
+        JSON_VARIANT_OBJECT_FOREACH(k, e, v)
+                ASSERT_OK(strv_extend(&keys, k));
+        strv_sort(keys);
+
+        STRV_FOREACH(i, keys)
+                ASSERT_OK(sd_json_variant_set_field(&sorted, *i, sd_json_variant_by_key(v, *i)));
+
+        ASSERT_NOT_NULL(f = memstream_init(&m));
+        ASSERT_OK(sd_json_variant_dump(sorted, output_mode_to_json_format_flags(mode), f, NULL));
+        ASSERT_OK(memstream_finalize(&m, &expected, NULL));
+
+        log_debug("%s", direct);
+        ASSERT_STREQ(direct, expected);
+}
+
+TEST(output_json_direct) {
+        _cleanup_(rm_rf_physical_and_freep) char *t = NULL;
+        _cleanup_(sd_journal_closep) sd_journal *j = NULL;
+        unsigned n = 0;
+
+        ASSERT_OK(mkdtemp_malloc("/var/tmp/test-logs-show-XXXXXX", &t));
+        (void) chattr_path(t, FS_NOCOW_FL, FS_NOCOW_FL);
+
+        append_entries(t);
+
+        ASSERT_OK(sd_journal_open_directory(&j, t, SD_JOURNAL_ASSUME_IMMUTABLE));
+
+        SD_JOURNAL_FOREACH(j) {
+                FOREACH_ELEMENT(mode, ((const OutputMode[]) { OUTPUT_JSON, OUTPUT_JSON_SSE, OUTPUT_JSON_SEQ })) {
+                        test_json_direct_one(j, *mode, /* flags= */ 0);
+                        test_json_direct_one(j, *mode, OUTPUT_SHOW_ALL);
+                }
+                n++;
+        }
+
+        ASSERT_EQ(n, 3u);
+}
+
+DEFINE_TEST_MAIN(LOG_DEBUG);
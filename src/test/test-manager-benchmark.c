@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "sd-json.h"
+
+#include "fd-util.h"
+#include "fdset.h"
+#include "fileio.h"
+#include "manager.h"
+#include "manager-dump.h"
+#include "manager-serialize.h"
+#include "parse-util.h"
+#include "path-util.h"
+#include "rm-rf.h"
+#include "string-util.h"
+#include "tests.h"
+#include "time-util.h"
+#include "tmpfile-util.h"
+#include "unit.h"
+
+/* Generates N service units with a dependency graph resembling a real system (most units pull in a few
+ * widely used ones), plus a target pulling in all of them, and measures how long the manager takes to load
+ * them, to compute the transaction for starting the target, to serialize its state (as done on
+ * daemon-reload), and to dump all units (comparable to enumerating them via ListUnits). The results are
+ * printed as a JSON object.
+ *
+ * Usage: test-manager-benchmark [N_UNITS] */
+
+static unsigned arg_n_units = 1000;
+
+static void generate_units(const char *dir) {
+        _cleanup_free_ char *wants_dir = NULL;
+        uint64_t state = 0x2545f4914f6cdd1d; /* Fixed seed, so that every run generates the same graph */
+
+        ASSERT_NOT_NULL(wants_dir = path_join(dir, "bench.target.wants"));
+        ASSERT_OK_ERRNO(mkdir(wants_dir, 0755));
+
+        ASSERT_OK(write_string_filef(
+                        strjoina(dir, "/bench.target"),
+                        WRITE_STRING_FILE_CREATE,
+                        "[Unit]\n"
+                        "Description=Benchmark target\n"));
+
+        for (unsigned i = 0; i < arg_n_units; i++) {
+                _cleanup_free_ char *name = NULL, *path = NULL, *link = NULL, *deps = NULL;
+
+                ASSERT_OK(asprintf(&name, "bench-%u.service", i));
+                ASSERT_NOT_NULL(path = path_join(dir, name));
+                ASSERT_NOT_NULL(link = path_join(wants_dir, name));
+
+                for (unsigned k = 0; i > 0 && k < 3; k++)
+                        ASSERT_OK(strextendf_with_separator(&deps, " ", "bench-%u.service", test_random_skewed(&state, i)));
+
+                ASSERT_OK(write_string_filef(
+                                path,
+                                WRITE_STRING_FILE_CREATE,
+                                "[Unit]\n"
+                                "Description=Benchmark service %u\n"
+                                "Wants=%s\n"
+                                "After=%s\n"
+                                "[Service]\n"
+                                "Type=oneshot\n"
+                                "RemainAfterExit=yes\n"
+                                "ExecStart=/bin/true\n",
+                                i, strempty(deps), strempty(deps)));
+
+                ASSERT_OK_ERRNO(symlink(path, link));
+        }
+}
+
+int main(int argc, char *argv[]) {
+        _cleanup_(rm_rf_physical_and_freep) char *runtime_dir = NULL, *unit_dir = NULL;
+        _cleanup_(sd_json_variant_unrefp) sd_json_variant *v = NULL;
+        _cleanup_(manager_freep) Manager *m = NULL;
+        _cleanup_fdset_free_ FDSet *fds = NULL;
+        _cleanup_fclose_ FILE *f = NULL, *null = NULL;
+        usec_t start, startup_usec, load_usec, transaction_usec, serialize_usec, dump_usec;
+        struct rusage ru;
+        Unit *target;
+        unsigned n_jobs;
+        int r;
+
+        test_setup_logging(LOG_INFO);
+
+        if (argc >= 2)
+                ASSERT_OK(safe_atou(argv[1], &arg_n_units));
+
+        r = enter_cgroup_subroot(NULL);
+        if (r == -ENOMEDIUM)
+                return log_tests_skipped("cgroupfs not available");
+
+        ASSERT_OK(mkdtemp_malloc("/tmp/test-manager-benchmark-XXXXXX", &unit_dir));
+        generate_units(unit_dir);
+
+        ASSERT_OK(setenv_unit_path(unit_dir));
+        ASSERT_NOT_NULL(runtime_dir = setup_fake_runtime_dir());
+
+        start = now(CLOCK_MONOTONIC);
+        r = manager_new(RUNTIME_SCOPE_USER, MANAGER_TEST_RUN_BASIC, &m);
+        if (manager_errno_skip_test(r))
+                return log_tests_skipped_errno(r, "manager_new");
+        ASSERT_OK(r);
+        ASSERT_OK(manager_startup(m, NULL, NULL, NULL));
+        startup_usec = usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+
+        start = now(CLOCK_MONOTONIC);
+        ASSERT_OK(manager_load_startable_unit_or_warn(m, "bench.target", NULL, &target));
+        load_usec = usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+
+        start = now(CLOCK_MONOTONIC);
+        ASSERT_OK(manager_add_job(m, JOB_START, target, JOB_REPLACE, NULL, NULL));
+        transaction_usec = usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+        n_jobs = hashmap_size(m->jobs);
+        manager_clear_jobs(m);
+
+        ASSERT_OK(manager_open_serialization(m, &f));
+        ASSERT_NOT_NULL(fds = fdset_new());
+        start = now(CLOCK_MONOTONIC);
+        ASSERT_OK(manager_serialize(m, f, fds, /* switching_root = */ false));
+        ASSERT_OK(fflush_and_check(f));
+        serialize_usec = usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+
+        ASSERT_NOT_NULL(null = fopen("/dev/null", "we"));
+        start = now(CLOCK_MONOTONIC);
+        manager_dump_units(m, null, /* patterns= */ NULL, /* prefix= */ NULL);
+        ASSERT_OK(fflush_and_check(null));
+        dump_usec = usec_sub_unsigned(now(CLOCK_MONOTONIC), start);
+
+        ASSERT_OK_ERRNO(getrusage(RUSAGE_SELF, &ru));
+
+        ASSERT_OK(sd_json_buildo(
+                        &v,
+                        SD_JSON_BUILD_PAIR_UNSIGNED("units", hashmap_size(m->units)),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("jobs", n_jobs),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("startupUSec", startup_usec),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("loadUSec", load_usec),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("transactionUSec", transaction_usec),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("serializeUSec", serialize_usec),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("dumpUSec", dump_usec),
+                        SD_JSON_BUILD_PAIR_UNSIGNED("maxRSSKiB", ru.ru_maxrss)));
+
+        ASSERT_OK(sd_json_variant_dump(v, SD_JSON_FORMAT_NEWLINE, stdout, NULL));
+
+        return 0;
+}
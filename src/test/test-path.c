@@ -22,7 +22,7 @@ typedef void (*test_function_t)(Manager *m);
 
 static int setup_test(Manager **m) {
         char **tests_path = STRV_MAKE("exists", "existsglobFOOBAR", "changed", "modified", "unit",
-                                      "directorynotempty", "makedirectory");
+                                      "directorynotempty", "makedirectory", "shared");
         Manager *tmp = NULL;
         int r;
 
@@ -378,6 +378,84 @@ static void test_path_makedirectory_directorymode(Manager *m) {
         (void) rm_rf(test_path, REMOVE_ROOT|REMOVE_PHYSICAL);
 }
 
+static void test_path_shared_inode(Manager *m) {
+        _cleanup_fclose_ FILE *f = NULL;
+        const char *test_path = "/tmp/test-path_shared";
+        Unit *changed_unit = NULL, *modified_unit = NULL;
+        Path *changed = NULL, *modified = NULL;
+        Service *changed_service = NULL, *modified_service = NULL;
+
+        assert_se(m);
+
+        /* Both path units watch the same inode, hence share the watch descriptor on the manager's inotify
+         * instance, but are interested in different events. */
+
+        assert_se(touch(test_path) >= 0);
+
+        assert_se(manager_load_startable_unit_or_warn(m, "path-sharedmodified.path", NULL, &modified_unit) >= 0);
+        assert_se(manager_load_startable_unit_or_warn(m, "path-sharedchanged.path", NULL, &changed_unit) >= 0);
+
+        modified = PATH(modified_unit);
+        modified_service = service_for_path(m, modified, NULL);
+        changed = PATH(changed_unit);
+        changed_service = service_for_path(m, changed, NULL);
+
+        /* Start the PathModified= unit first, so that the PathChanged= unit, which asks for fewer events,
+         * must not replace the events the former asked for. */
+        assert_se(unit_start(modified_unit, NULL) >= 0);
+        if (check_states(m, modified, modified_service, PATH_WAITING, SERVICE_DEAD) < 0)
+                return;
+
+        assert_se(unit_start(changed_unit, NULL) >= 0);
+        if (check_states(m, changed, changed_service, PATH_WAITING, SERVICE_DEAD) < 0)
+                return;
+
+        /* IN_MODIFY is only of interest for the PathModified= unit */
+        f = fopen(test_path, "we");
+        assert_se(f);
+        assert_se(fputs("test", f) >= 0);
+        assert_se(fflush(f) == 0);
+
+        if (check_states(m, modified, modified_service, PATH_RUNNING, SERVICE_RUNNING) < 0)
+                return;
+        if (check_states(m, changed, changed_service, PATH_WAITING, SERVICE_DEAD) < 0)
+                return;
+
+        /* IN_CLOSE_WRITE is of interest for both */
+        f = safe_fclose(f);
+        if (check_states(m, changed, changed_service, PATH_RUNNING, SERVICE_RUNNING) < 0)
+                return;
+
+        assert_se(unit_stop(UNIT(modified_service)) >= 0);
+        if (check_states(m, modified, modified_service, PATH_WAITING, SERVICE_DEAD) < 0)
+                return;
+        assert_se(unit_stop(UNIT(changed_service)) >= 0);
+        if (check_states(m, changed, changed_service, PATH_WAITING, SERVICE_DEAD) < 0)
+                return;
+
+        /* The shared watch must stay in place for the PathChanged= unit when the other one stops watching */
+        assert_se(unit_stop(modified_unit) >= 0);
+        if (check_states(m, modified, modified_service, PATH_DEAD, SERVICE_DEAD) < 0)
+                return;
+
+        f = fopen(test_path, "we");
+        assert_se(f);
+        f = safe_fclose(f);
+        if (check_states(m, changed, changed_service, PATH_RUNNING, SERVICE_RUNNING) < 0)
+                return;
+
+        assert_se(unit_stop(UNIT(changed_service)) >= 0);
+        if (check_states(m, changed, changed_service, PATH_WAITING, SERVICE_DEAD) < 0)
+                return;
+
+        assert_se(unit_stop(changed_unit) >= 0);
+
+        /* All watches are removed once nobody uses them anymore */
+        assert_se(hashmap_isempty(m->path_inotify_wd_specs));
+
+        (void) rm_rf(test_path, REMOVE_ROOT|REMOVE_PHYSICAL);
+}
+
 int main(int argc, char *argv[]) {
         static const test_function_t tests[] = {
                 test_path_exists,
@@ -387,6 +465,7 @@ int main(int argc, char *argv[]) {
                 test_path_unit,
                 test_path_directorynotempty,
                 test_path_makedirectory_directorymode,
+                test_path_shared_inode,
                 NULL,
         };
 
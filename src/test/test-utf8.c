@@ -31,6 +31,13 @@ TEST(utf8_n_is_valid) {
         assert_se( utf8_is_valid_n("<ZZ>", 3));
         assert_se( utf8_is_valid_n("<ZZ>", 4));
         assert_se(!utf8_is_valid_n("<ZZ>", 5));
+
+        /* Longer than a word, to cover the ASCII fast path */
+        assert_se( utf8_is_valid_n("0123456789abcdef\342\204\242xyz", 22));
+        assert_se(!utf8_is_valid_n("0123456789abcdef\342\204xyz", 21));
+        assert_se(!utf8_is_valid_n("0123456789ab\0defghijklmnop", 27));
+        assert_se( utf8_is_valid_n("0123456789ab\0defghijklmnop", 12));
+        assert_se(!utf8_is_valid_n("01234567\37789abcdefgh", 17));
 }
 
 TEST(utf8_is_valid) {
@@ -3185,19 +3185,15 @@ static int udev_rule_apply_parent_token_to_event(UdevRuleToken *head_token, Udev
         }
 }
 
-static int udev_rule_apply_line_to_event(
-                UdevRuleLine *line,
-                UdevEvent *event,
-                UdevRuleLine **next_line) {
-
+static int udev_event_get_line_type_mask(UdevEvent *event, UdevRuleLineType *ret) {
         UdevRuleLineType mask = LINE_HAS_GOTO | LINE_UPDATE_SOMETHING;
-        bool parents_done = false;
         sd_device_action_t action;
         int r;
 
-        assert(line);
         assert(event);
-        assert(next_line);
+        assert(ret);
+
+        /* Returns the types of rule lines that may have an effect on this event. */
 
         r = sd_device_get_action(event->dev, &action);
         if (r < 0)
@@ -3211,6 +3207,23 @@ static int udev_rule_apply_line_to_event(
                         mask |= LINE_HAS_NAME;
         }
 
+        *ret = mask;
+        return 0;
+}
+
+static int udev_rule_apply_line_to_event(
+                UdevRuleLine *line,
+                UdevEvent *event,
+                UdevRuleLineType mask,
+                UdevRuleLine **next_line) {
+
+        bool parents_done = false;
+        int r;
+
+        assert(line);
+        assert(event);
+        assert(next_line);
+
         if ((line->type & mask) == 0)
                 return 0;
 
@@ -3245,14 +3258,21 @@ static int udev_rule_apply_line_to_event(
 }
 
 int udev_rules_apply_to_event(UdevRules *rules, UdevEvent *event) {
+        UdevRuleLineType mask;
         int r;
 
         assert(rules);
         assert(event);
 
+        /* The action, devnum and ifindex of the device do not change while the rules are applied, hence
+         * determine once which lines may apply, rather than for each line. */
+        r = udev_event_get_line_type_mask(event, &mask);
+        if (r < 0)
+                return r;
+
         LIST_FOREACH(rule_files, file, rules->rule_files)
                 LIST_FOREACH_WITH_NEXT(rule_lines, line, next_line, file->rule_lines) {
-                        r = udev_rule_apply_line_to_event(line, event, &next_line);
+                        r = udev_rule_apply_line_to_event(line, event, mask, &next_line);
                         if (r < 0)
                                 return r;
                 }